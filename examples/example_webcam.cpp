@@ -1,9 +1,13 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
-#include <map>
+#include <condition_variable>
+#include <mutex>
 #include <opencv2/opencv.hpp>
+#include <optional>
 #include <string>
+#include <thread>
+#include <tuple>
 
 #include "hastings/pipeline/context.h"
 #include "hastings/pipeline/node.h"
@@ -11,60 +15,97 @@
 #include "hastings/pipeline/visualizer.h"
 
 namespace hastings {
-class VideoCaptureNode final : public NodeInterface {
+class VideoCaptureNode final : public AsyncNodeInterface {
   public:
-    explicit VideoCaptureNode(const int index) : source_(index) { CHECK(source_.isOpened()) << "failed to open webcam"; }
+    explicit VideoCaptureNode(const int index) : source_(index) {
+        CHECK(source_.isOpened()) << "failed to open webcam";
+        thread_ = std::thread([this] { capture(); });
+    }
+
+    explicit VideoCaptureNode(const std::string& filename) : source_(filename) {
+        CHECK(source_.isOpened()) << "failed to open video";
+        thread_ = std::thread([this] { capture(); });
+    }
 
-    explicit VideoCaptureNode(const std::string& filename) : source_(filename) { CHECK(source_.isOpened()) << "failed to open video"; }
+    ~VideoCaptureNode() {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        thread_.join();
+    }
 
     ExecutionPolicy executionPolicy() const override final { return ExecutionPolicy::Ordered; }
     std::string name() const override final { return "VideoCaptureNode"; }
+    std::optional<Dependencies> dependencies() const override final { return Dependencies{{}, {"BGR", "flipped BGR"}}; }
 
-    void process(MultiImageContextInterface& multi_context) override final {
-        auto context = multi_context.cameras("camera");
-        source_.read(context->image("BGR"));
-
-        auto other_context = multi_context.cameras("dummy camera");
-        context->image("BGR").copyTo(other_context->image("BGR"));
-        cv::flip(other_context->image("BGR"), other_context->image("flipped BGR"), 0);
+    // NOTE(will): reads block on the device, so they're handed to the capture thread and the worker goes back to the pool.
+    void processAsync(MultiImageContextInterface& multi_context, FnDone&& done) override final {
+        {
+            std::lock_guard lock(mutex_);
+            request_ = Request{&multi_context, std::move(done)};
+        }
+        cv_.notify_one();
     }
 
   private:
-    cv::VideoCapture source_;
-};
-
-class FrameDiffNode final : public NodeInterface {
-  public:
-    ExecutionPolicy executionPolicy() const override final { return ExecutionPolicy::Ordered; }
-    std::string name() const override final { return "FrameDiffNode"; }
+    using Request = std::tuple<MultiImageContextInterface*, FnDone>;
+
+    void capture() {
+        while (true) {
+            std::unique_lock lock(mutex_);
+            cv_.wait(lock, [this] { return stop_ || request_.has_value(); });
+            if (stop_) {
+                return;
+            }
 
-    void process(MultiImageContextInterface& multi_context) override final {
-        for (auto& [cameraName, context] : multi_context.cameras()) {
-            const auto& image = context->image("BGR");
+            auto [multi_context, done] = std::move(*request_);
+            request_.reset();
+            lock.unlock();
 
-            auto previous_image = previous_images_[cameraName];
-            if (previous_image.empty()) {
-                previous_image = image;
-            }
+            auto context = multi_context->cameras(camera_);
+            source_.read(context->image(bgr_));
 
-            cv::absdiff(image, previous_image, context->image("diff"));
-            image.copyTo(previous_images_[cameraName]);
+            auto other_context = multi_context->cameras(dummy_camera_);
+            other_context->alias(bgr_, *context, bgr_);
+            cv::flip(other_context->view(bgr_), other_context->image(flipped_bgr_), 0);
+            done();
         }
     }
 
-  private:
-    std::map<std::string, cv::Mat> previous_images_;
+    const CameraId camera_{"camera"};
+    const CameraId dummy_camera_{"dummy camera"};
+    const Key bgr_{"BGR"};
+    const Key flipped_bgr_{"flipped BGR"};
+
+    cv::VideoCapture source_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::optional<Request> request_;
+    std::thread thread_;
 };
 
-class ConvertBGR2Y final : public NodeInterface {
-    ExecutionPolicy executionPolicy() const override final { return ExecutionPolicy::Parallel; }
-    std::string name() const override final { return "ConvertBGR2Y"; }
+class FrameDiffNode final : public CameraNodeInterface {
+  public:
+    // NOTE(will): a camera's frames run in order, so the previous frame's BGR writer has finished and it's been recorded
+    ExecutionPolicy executionPolicy() const override final { return ExecutionPolicy::OrderedPerCamera; }
+    std::string name() const override final { return "FrameDiffNode"; }
+    std::optional<Dependencies> dependencies() const override final { return Dependencies{{"BGR"}, {"diff"}}; }
+
+    // NOTE(will): the previous frame's BGR comes from the retained history, it's empty on the first frame, which makes an empty
+    // diff.
+    void processCamera(const std::string&, ImageContextInterface& context) override final {
+        const auto& image = context.view(bgr_);
+        const auto previous_image = context.history(bgr_, 1);
 
-    void process(MultiImageContextInterface& multi_context) override final {
-        for (const auto& [camera, context] : multi_context.cameras()) {
-            cv::cvtColor(context->image("BGR"), context->image("Y"), cv::COLOR_BGR2GRAY);
-        }
+        cv::absdiff(image, previous_image.empty() ? image : previous_image, context.image(diff_));
     }
+
+  private:
+    const Key bgr_{"BGR"};
+    const Key diff_{"diff"};
 };
 
 class OpticalFlowNode final : public NodeInterface {
@@ -74,18 +115,26 @@ class OpticalFlowNode final : public NodeInterface {
 
     ExecutionPolicy executionPolicy() const override final { return ExecutionPolicy::Ordered; }
     std::string name() const override final { return "OpticalFlowNode"; }
+    std::optional<Dependencies> dependencies() const override final { return Dependencies{{"Y", "BGR"}, {"pyramid", "flow"}}; }
+
+    // NOTE(will): the pyramid only depends on the current frame, so it's built out of order ahead of the tracking
+    void prepare(MultiImageContextInterface& multi_context) override final {
+        const auto context = multi_context.cameras(camera_);
+        cv::buildOpticalFlowPyramid(context->view(y_), context->result(pyramid_), cv::Size(21, 21), 3);
+    }
 
     void process(MultiImageContextInterface& multi_context) override final {
-        // NOTE(will): add better support for single image operations...
-        const auto context = multi_context.cameras("camera");
+        const auto context = multi_context.cameras(camera_);
 
-        std::vector<cv::Mat> nextPyramid;
+        auto& nextPyramid = context->result(pyramid_);
         std::vector<cv::Point2f> nextPts;
         std::vector<uchar> status;
         std::vector<float> err;
 
-        cv::Mat& image_y = context->image("Y");
-        cv::buildOpticalFlowPyramid(image_y, nextPyramid, cv::Size(21, 21), 3);
+        const cv::Mat& image_y = context->view(y_);
+
+        // NOTE(will): the tracks are drawn over an alias of BGR the node owns, BGR's own graphics are left to its writer
+        context->alias(flow_, bgr_);
 
         if (!prevPyramid_.empty() && !prevPoints_.empty()) {
             std::vector<cv::Point2f> prevCVPts;
@@ -95,7 +144,7 @@ class OpticalFlowNode final : public NodeInterface {
 
             cv::calcOpticalFlowPyrLK(prevPyramid_, nextPyramid, prevCVPts, nextPts, status, err);
 
-            VectorGraphics graphics;
+            VectorGraphics graphics(&context->arena());
             graphics.reserve(prevPoints_.size() * 2);
             for (size_t i = 0; i < prevPoints_.size(); ++i) {
                 if (status[i]) {
@@ -109,7 +158,7 @@ class OpticalFlowNode final : public NodeInterface {
             graphics.emplace_back(TextGraphic{{0, 255, 255}, {50, 60}, "hello world"});
             graphics.emplace_back(RectangleGraphic{{255, 0, 255}, {50, 60}, {100, 170}});
 
-            context->vectorGraphic("BGR", std::move(graphics));
+            context->vectorGraphic("flow", std::move(graphics));
 
             for (auto i = 0; i < prevPoints_.size(); ++i) {
                 prevPoints_[i].good = bool(status[i]);
@@ -140,6 +189,12 @@ class OpticalFlowNode final : public NodeInterface {
         bool good = true;
     };
 
+    const CameraId camera_{"camera"};
+    const Key y_{"Y"};
+    const Key bgr_{"BGR"};
+    const Key flow_{"flow"};
+    const ResultKey<std::vector<cv::Mat>> pyramid_{"pyramid"};
+
     int maxCorners_;
     double quality_;
     double minDistance_;
@@ -152,9 +207,10 @@ class OpticalFlowNode final : public NodeInterface {
 }  // namespace hastings
 
 int main(int argc, char** argv) {
-    using hastings::ConvertBGR2Y;
     using hastings::createPipeline;
     using hastings::FrameDiffNode;
+    using hastings::ImageContextInterface;
+    using hastings::Key;
     using hastings::OpticalFlowNode;
     using hastings::VideoCaptureNode;
     using hastings::VisualizerStreamerNode;
@@ -163,11 +219,20 @@ int main(int argc, char** argv) {
     google::ParseCommandLineFlags(&argc, &argv, true);
 
     LOG(INFO) << "creating pipeline";
-    auto pipeline = createPipeline(5);
+    auto pipeline = createPipeline();
+    pipeline->addCamera("camera");
+    pipeline->addCamera("dummy camera");
+
+    // NOTE(will): Y is only made for the cameras something reads it from
+    pipeline->derive("Y", {"BGR"}, [bgr = Key("BGR")](ImageContextInterface& context, cv::Mat& image) {
+        cv::cvtColor(context.view(bgr), image, cv::COLOR_BGR2GRAY);
+    });
+
+    // NOTE(will): FrameDiffNode reads the last frame's BGR
+    pipeline->retain("BGR", 1);
 
     pipeline->add<VideoCaptureNode>(0);
     pipeline->add<FrameDiffNode>();
-    pipeline->add<ConvertBGR2Y>();
     pipeline->add<OpticalFlowNode>(50, 0.01, 30);
     pipeline->add<VisualizerStreamerNode>();
 
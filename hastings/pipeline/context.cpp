@@ -1,123 +1,609 @@
 #include "hastings/pipeline/context.h"
 
-#include <map>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "hastings/pipeline/frame_arena.h"
+#include "hastings/pipeline/frame_history.h"
+#include "hastings/pipeline/frame_pool.h"
 
 namespace hastings {
 
+// NOTE(will): storage is indexed by key id, a chunk of slots at a time. chunks are never freed or moved, so lookups of an allocated
+// chunk don't take the lock and references handed out stay valid. nodes of the same frame can run concurrently, creating an entry
+// and appending graphics are still guarded.
 class ImageContext : public ImageContextInterface {
   public:
-    void clear() final {
-        for (auto& [key, value] : data_) {
-            value.reset();
-        }
+    explicit ImageContext(const std::size_t history_index = FrameHistory::frame_index)
+        : history_index_(history_index), cleared_allocations_(framePool().stats().num_allocations) {}
+    ImageContext(const ImageContext&) = delete;
+    ImageContext& operator=(const ImageContext&) = delete;
 
-        for (auto& [key, data] : images_) {
-            data.image = cv::Mat();
-            data.graphics.clear();
+    ~ImageContext() {
+        for (auto& chunk : chunks_) {
+            delete chunk.load();
         }
     }
 
+    // NOTE(will): images go back to the frame pool rather than the heap, the next frame's images of the same size reuse them.
+    // everything that may hold arena memory is released before the arena is reset.
+    void clear() final {
+        auto& pool = framePool();
+        const auto num_allocations = pool.stats().num_allocations;
+
+        std::lock_guard lock(mutex_);
+        forEachSlot([this, &pool](Slot& slot) {
+            if (slot.image.u != nullptr && isNew(slot)) {
+                slot.buffer_frame = id_;
+            }
+            slot.buffer = slot.image.u;
+
+            slot.result.reset();
+            slot.image = cv::Mat();
+            slot.image.allocator = &pool;
+            slot.shared = false;
+            slot.aliased = false;
+            slot.derived = false;
+            if (slot.graphics) {
+                slot.graphics.emplace(&arena_);
+            }
+
+            if (slot.typed_storage) {
+                slot.typed_storage->clear();
+            }
+        });
+        cleared_allocations_ = num_allocations;
+        arena_.reset();
+    }
+
     void time(Time t) override final { time_ = t; }
     Time time() const override final { return time_; }
 
     void frameId(const std::size_t& id) override final { id_ = id; }
     std::size_t frameId() const override final { return id_; };
 
-    std::any& result(const std::string& name) override final { return data_[name]; }
+    std::any& result(const std::string& name) override final { return slot(name).result; }
+    std::any& result(const Key& key) override final { return slot(key).result; }
+
+    cv::Mat& image(const std::string& name) override final { return writeImage(imageSlot(name)); }
+    cv::Mat& image(const Key& key) override final { return writeImage(imageSlot(key)); }
+
+    void alias(const Key& key, ImageContextInterface& source, const Key& source_key) override final {
+        const auto& image = source.shareImage(source_key);
+
+        auto& image_slot = imageSlot(key);
+        if (&image_slot.image == &image) {
+            return;
+        }
+
+        image_slot.image = image;
+        image_slot.aliased = true;
+        image_slot.shared.store(true, std::memory_order_release);
+    }
+
+    const cv::Mat& view(const std::string& name) override final { return readImage(imageSlot(name)); }
+    const cv::Mat& view(const Key& key) override final { return readImage(imageSlot(key)); }
+
+    const cv::Mat& shareImage(const Key& key) override final {
+        auto& image_slot = imageSlot(key);
+        makeDerived(image_slot);
+        image_slot.shared.store(true, std::memory_order_release);
+        return image_slot.image;
+    }
 
-    cv::Mat& image(const std::string& name) override final { return images_[name].image; }
+    TypedResultBase& typedResult(const Key& key, const FnCreateResult create) override final {
+        auto& typed_slot = slot(key);
+
+        auto typed = typed_slot.typed.load(std::memory_order_acquire);
+        if (typed == nullptr) {
+            std::lock_guard lock(mutex_);
+            typed = typed_slot.typed.load(std::memory_order_relaxed);
+            if (typed == nullptr) {
+                typed_slot.typed_storage = create(arena_);
+                typed_slot.typed_frame = id_;
+                typed_slot.name = &key.name();
+                typed = typed_slot.typed_storage.get();
+                typed_slot.typed.store(typed, std::memory_order_release);
+            }
+        }
+        return *typed;
+    }
+
+    void derive(const Key& key, const FnDerive& fn) override final {
+        auto& image_slot = imageSlot(key);
+
+        std::lock_guard lock(image_slot.derive_mutex);
+        image_slot.derive = fn;
+    }
 
     void images(const FnImage& fn_image) override final {
-        for (auto& [name, image] : images_) {
-            fn_image(name, image.image);
+        std::vector<std::tuple<const std::string*, cv::Mat*>> images;
+        forEachImage([&images](Slot& slot) {
+            if (isMade(slot)) {
+                images.emplace_back(slot.name, &slot.image);
+            }
+        });
+
+        for (auto& [name, image] : images) {
+            fn_image(*name, *image);
         }
     }
 
     void images(const FnConstImage& fn_image) const override final {
-        for (auto& [name, image] : images_) {
-            fn_image(name, image.image);
+        std::vector<std::tuple<const std::string*, const cv::Mat*>> images;
+        forEachImage([&images](Slot& slot) {
+            if (isMade(slot)) {
+                images.emplace_back(slot.name, &slot.image);
+            }
+        });
+
+        for (auto& [name, image] : images) {
+            fn_image(*name, *image);
+        }
+    }
+
+    void imageNames(const FnName& fn_name) const override final {
+        std::vector<const std::string*> names;
+        forEachImage([&names](Slot& slot) { names.emplace_back(slot.name); });
+
+        for (const auto name : names) {
+            fn_name(*name);
+        }
+    }
+
+    cv::Mat history(const Key& key, const std::size_t frames_back) const override final {
+        if (history_ == nullptr || frames_back > id_) {
+            return cv::Mat();
+        }
+        return history_->image(history_index_, key, id_ - frames_back);
+    }
+
+    void history(const FrameHistory* frame_history) override final { history_ = frame_history; }
+    const FrameHistory* history() const override final { return history_; }
+
+    void vectorGraphic(const std::string& image_name, VectorGraphics&& graphics) override final {
+        auto& slot = imageSlot(image_name);
+
+        std::lock_guard lock(mutex_);
+        slot.graphics->insert(slot.graphics->end(), std::make_move_iterator(graphics.begin()), std::make_move_iterator(graphics.end()));
+    }
+
+    const VectorGraphics& vectorGraphic(const std::string& image_name) const override final {
+        const Slot* slot = nullptr;
+        if (const auto key = Key::tryIntern(image_name)) {
+            const auto slots = chunks_[key->id() / chunk_size].load(std::memory_order_acquire);
+            slot = slots == nullptr ? nullptr : &(*slots)[key->id() % chunk_size];
+        } else {
+            std::lock_guard lock(mutex_);
+            const auto iter = overflow_.find(image_name);
+            slot = iter == overflow_.end() ? nullptr : iter->second.get();
         }
+
+        if (slot == nullptr || !slot->has_image.load(std::memory_order_acquire)) {
+            throw std::out_of_range("no image named " + image_name);
+        }
+
+        std::lock_guard lock(mutex_);
+        return *slot->graphics;
     }
 
-    void vectorGraphic(const std::string& image_name, std::vector<VectorGraphic>&& graphics) override final {
-        auto& image_data = images_[image_name];
-        image_data.graphics.insert(image_data.graphics.end(), graphics.begin(), graphics.end());
+    std::pmr::memory_resource& arena() override final { return arena_; }
+
+    std::size_t bytes() const override final {
+        auto bytes = arena_.capacity();
+
+        std::lock_guard lock(mutex_);
+        forEachSlot([&bytes](const Slot& slot) {
+            if (slot.image.u != nullptr && !slot.aliased) {
+                bytes += slot.image.u->size;
+            }
+
+            if (slot.typed_storage) {
+                bytes += slot.typed_storage->bytes();
+            }
+        });
+        return bytes;
     }
 
-    const std::vector<VectorGraphic>& vectorGraphic(const std::string& image_name) const override final {
-        return images_.at(image_name).graphics;
+    std::vector<KeyMemory> memory() const override final {
+        std::vector<KeyMemory> memory;
+
+        std::lock_guard lock(mutex_);
+        forEachSlot([this, &memory](const Slot& slot) {
+            if (slot.image.u != nullptr && !slot.aliased) {
+                const auto is_new = isNew(slot);
+                const auto since = is_new ? id_ : slot.buffer_frame;
+                memory.emplace_back(KeyMemory{{}, *slot.name, slot.image.u->size, is_new, id_ - since + 1});
+            }
+
+            if (slot.typed_storage) {
+                const auto is_new = slot.typed_frame == id_;
+                memory.emplace_back(KeyMemory{{}, *slot.name, slot.typed_storage->bytes(), is_new, id_ - slot.typed_frame + 1});
+            }
+        });
+        return memory;
     }
 
   private:
-    struct ImageData {
+    struct Slot {
+        std::any result;
         cv::Mat image;
-        std::vector<VectorGraphic> graphics;
+
+        // made in the arena with the image, a pmr vector's resource can't be replaced by assigning to it
+        std::optional<VectorGraphics> graphics;
+
+        std::atomic<TypedResultBase*> typed = nullptr;
+        std::unique_ptr<TypedResultBase> typed_storage;
+
+        // set while the image may share its buffer with an alias
+        std::atomic<bool> shared = false;
+
+        // set while the image is an alias of another, its buffer is counted by that one
+        bool aliased = false;
+
+        // the image's buffer when last cleared and the frame id it was taken from the heap at, the frame id the typed result was
+        // made at
+        const cv::UMatData* buffer = nullptr;
+        std::size_t buffer_frame = 0;
+        std::size_t typed_frame = 0;
+
+        // makes a derived image, kept across clear(). derived is set once this frame's image has been made
+        FnDerive derive;
+        std::atomic<bool> derived = false;
+        std::mutex derive_mutex;
+
+        // set once the image is first used, it's then listed by images() like any other
+        std::atomic<bool> has_image = false;
+        const std::string* name = nullptr;
     };
 
+    static constexpr std::size_t chunk_size = 64;
+    using Chunk = std::array<Slot, chunk_size>;
+
+    Slot& slot(const Key& key) {
+        auto& chunk = chunks_[key.id() / chunk_size];
+
+        auto slots = chunk.load(std::memory_order_acquire);
+        if (slots == nullptr) {
+            std::lock_guard lock(mutex_);
+            slots = chunk.load(std::memory_order_acquire);
+            if (slots == nullptr) {
+                slots = new Chunk();
+                chunk.store(slots, std::memory_order_release);
+            }
+        }
+        return (*slots)[key.id() % chunk_size];
+    }
+
+    // NOTE(will): once every Key is taken, names that aren't one get a slot in this context only. nothing else can name them by
+    // Key, as none can be made for them any more.
+    Slot& slot(const std::string& name) {
+        if (const auto key = Key::tryIntern(name)) {
+            return slot(*key);
+        }
+        return overflowSlot(name);
+    }
+
+    Slot& overflowSlot(const std::string& name) {
+        std::lock_guard lock(mutex_);
+        auto [iter, is_new] = overflow_.try_emplace(name);
+        if (is_new) {
+            iter->second = std::make_unique<Slot>();
+            iter->second->name = &iter->first;
+        }
+        return *iter->second;
+    }
+
+    Slot& imageSlot(const Key& key) { return makeImage(slot(key), key.name()); }
+
+    Slot& imageSlot(const std::string& name) {
+        if (const auto key = Key::tryIntern(name)) {
+            return imageSlot(*key);
+        }
+
+        auto& image_slot = overflowSlot(name);
+        return makeImage(image_slot, *image_slot.name);
+    }
+
+    Slot& makeImage(Slot& image_slot, const std::string& name) {
+        if (!image_slot.has_image.load(std::memory_order_acquire)) {
+            std::lock_guard lock(mutex_);
+            if (!image_slot.has_image.load(std::memory_order_relaxed)) {
+                image_slot.image.allocator = &framePool();
+                image_slot.graphics.emplace(&arena_);
+                image_slot.name = &name;
+                image_slot.has_image.store(true, std::memory_order_release);
+            }
+        }
+        return image_slot;
+    }
+
+    const cv::Mat& readImage(Slot& image_slot) {
+        makeDerived(image_slot);
+        return image_slot.image;
+    }
+
+    cv::Mat& writeImage(Slot& image_slot) {
+        makeDerived(image_slot);
+        if (image_slot.shared.load(std::memory_order_acquire)) {
+            unshare(image_slot);
+        }
+        return image_slot.image;
+    }
+
+    // NOTE(will): concurrent readers of a derived image wait on the first one making it, rather than each making their own.
+    // derivations are registered between frames, so checking for one doesn't need the lock.
+    void makeDerived(Slot& image_slot) {
+        if (!image_slot.derive || image_slot.derived.load(std::memory_order_acquire)) {
+            return;
+        }
+
+        std::lock_guard lock(image_slot.derive_mutex);
+        if (!image_slot.derived.load(std::memory_order_relaxed)) {
+            image_slot.derive(*this, image_slot.image);
+            image_slot.derived.store(true, std::memory_order_release);
+        }
+    }
+
+    // NOTE(will): the pool hands buffers between contexts, so a pooled buffer is new only if the pool took it from the heap since
+    // this context was last cleared. other buffers can only be told apart by address.
+    bool isNew(const Slot& image_slot) const {
+        const auto u = image_slot.image.u;
+        const auto serial = FramePool::serial(u);
+        return serial != 0 ? serial > cleared_allocations_ : u != image_slot.buffer;
+    }
+
+    static bool isMade(const Slot& image_slot) { return !image_slot.derive || image_slot.derived.load(std::memory_order_acquire); }
+
+    // NOTE(will): the other side may have already taken its own copy, in which case this one is no longer shared. its release can
+    // run concurrently, so the count is read with the same atomic op cv::Mat updates it with.
+    static void unshare(Slot& image_slot) {
+        const auto& image = image_slot.image;
+        if (image.u != nullptr && CV_XADD(&image.u->refcount, 0) > 1) {
+            cv::Mat copy;
+            copy.allocator = &framePool();
+            image.copyTo(copy);
+            image_slot.image = std::move(copy);
+        }
+        image_slot.aliased = false;
+        image_slot.shared.store(false, std::memory_order_release);
+    }
+
+    template <class FnSlot>
+    void forEachImage(const FnSlot& fn_slot) const {
+        std::lock_guard lock(mutex_);
+        forEachSlot([&fn_slot](Slot& slot) {
+            if (slot.has_image.load(std::memory_order_acquire)) {
+                fn_slot(slot);
+            }
+        });
+    }
+
+    // the caller holds mutex_
+    template <class FnSlot>
+    void forEachSlot(const FnSlot& fn_slot) const {
+        for (const auto& chunk : chunks_) {
+            const auto slots = chunk.load(std::memory_order_acquire);
+            if (slots == nullptr) {
+                continue;
+            }
+
+            for (auto& slot : *slots) {
+                fn_slot(slot);
+            }
+        }
+
+        for (const auto& [name, slot] : overflow_) {
+            fn_slot(*slot);
+        }
+    }
+
     Time time_;
-    std::size_t id_;
+    std::size_t id_ = 0;
+
+    const FrameHistory* history_ = nullptr;
+    std::size_t history_index_;
 
-    std::map<std::string, std::any> data_;
-    std::map<std::string, ImageData> images_;
+    // the frame pool's num_allocations when the context was last cleared
+    std::uint64_t cleared_allocations_;
+
+    mutable std::mutex mutex_;
+    FrameArena arena_;
+    std::array<std::atomic<Chunk*>, Key::max_keys / chunk_size> chunks_{};
+    std::unordered_map<std::string, std::unique_ptr<Slot>> overflow_;
 };
 
+// NOTE(will): cameras_ is reserved for every camera up front so its entries never move, table_ maps a camera's id to its context.
+// num_cameras_ publishes an entry once it's made, readers never look at cameras_.size() which emplace_back writes to. a name past
+// CameraId::max_cameras has its context kept in overflow_ instead, it has no id so it isn't in cameras() and has no history.
 class MultiImageContext final : public MultiImageContextInterface {
   public:
-    const Cameras& cameras() const override final { return cameras_; }
+    MultiImageContext() { cameras_.reserve(CameraId::max_cameras); }
+
+    Cameras cameras() const override final { return Cameras(cameras_.data(), num_cameras_.load(std::memory_order_acquire)); }
 
     ImageContextInterface* cameras(const std::string& name) override final {
-        auto iter = std::find_if(cameras_.begin(), cameras_.end(), [&name](const Camera& camera) { return std::get<0>(camera) == name; });
-        if (iter != cameras_.end()) {
-            return std::get<1>(*iter).get();
+        const auto camera = CameraId::tryIntern(name);
+        if (camera.has_value()) {
+            return cameras(camera.value());
+        }
+        return overflowCamera(name);
+    }
+
+    ImageContextInterface* cameras(const CameraId& camera) override final {
+        auto& entry = table_[camera.id()];
+
+        auto context = entry.load(std::memory_order_acquire);
+        if (context != nullptr) {
+            return context;
         }
 
-        auto& value = cameras_.emplace_back(Camera{name, createImageContext()});
-        return std::get<1>(value).get();
+        std::lock_guard lock(mutex_);
+        context = entry.load(std::memory_order_relaxed);
+        if (context == nullptr) {
+            auto& [name, created, id] =
+                cameras_.emplace_back(Camera{camera.name(), std::make_unique<ImageContext>(camera.id() + 1), camera});
+            created->frameId(context_.frameId());
+            created->time(context_.time());
+            created->history(history_);
+            for (const auto& [key, fn] : derivations_) {
+                created->derive(key, fn);
+            }
+
+            context = created.get();
+            num_cameras_.store(cameras_.size(), std::memory_order_release);
+            entry.store(context, std::memory_order_release);
+        }
+        return context;
     }
 
     void clear() override final {
         context_.clear();
-        for (auto& camera : cameras_) {
-            std::get<1>(camera)->clear();
-        }
+        forEachCamera([](const std::string&, ImageContextInterface& context) { context.clear(); });
+        previous_ = nullptr;
     }
 
+    MultiImageContextInterface* previous() const override final { return previous_; }
+    void previous(MultiImageContextInterface* multi_context) override final { previous_ = multi_context; }
+
     void time(const Time t) override final {
         context_.time(t);
-        for (auto& camera : cameras_) {
-            std::get<1>(camera)->time(t);
-        }
+        forEachCamera([t](const std::string&, ImageContextInterface& context) { context.time(t); });
     }
 
     Time time() const override final { return context_.time(); }
 
     void frameId(const std::size_t& id) override final {
         context_.frameId(id);
-        for (auto& camera : cameras_) {
-            std::get<1>(camera)->frameId(id);
-        }
+        forEachCamera([&id](const std::string&, ImageContextInterface& context) { context.frameId(id); });
     }
     std::size_t frameId() const override final { return context_.frameId(); };
 
     std::any& result(const std::string& name) override final { return context_.result(name); }
+    std::any& result(const Key& key) override final { return context_.result(key); }
 
     cv::Mat& image(const std::string& name) override final { return context_.image(name); }
+    cv::Mat& image(const Key& key) override final { return context_.image(key); }
+
+    void alias(const Key& key, ImageContextInterface& source, const Key& source_key) override final {
+        context_.alias(key, source, source_key);
+    }
+
+    const cv::Mat& view(const std::string& name) override final { return context_.view(name); }
+    const cv::Mat& view(const Key& key) override final { return context_.view(key); }
+    const cv::Mat& shareImage(const Key& key) override final { return context_.shareImage(key); }
+
+    TypedResultBase& typedResult(const Key& key, const FnCreateResult create) override final { return context_.typedResult(key, create); }
+
+    // NOTE(will): registered with every camera as well, including ones made later. registering key again replaces its fn.
+    void derive(const Key& key, const FnDerive& fn) override final {
+        std::lock_guard lock(mutex_);
+        const auto iter = std::find_if(derivations_.begin(), derivations_.end(),
+                                       [&key](const std::tuple<Key, FnDerive>& derivation) { return std::get<0>(derivation) == key; });
+        if (iter != derivations_.end()) {
+            std::get<1>(*iter) = fn;
+        } else {
+            derivations_.emplace_back(key, fn);
+        }
+
+        context_.derive(key, fn);
+        for (const auto& camera : cameras()) {
+            std::get<1>(camera)->derive(key, fn);
+        }
+        for (const auto& [name, context] : overflow_) {
+            context->derive(key, fn);
+        }
+    }
 
     void images(const FnImage& fn_image) override final { context_.images(fn_image); }
 
     void images(const FnConstImage& fn_image) const override final { context_.images(fn_image); }
 
-    void vectorGraphic(const std::string& image_name, std::vector<VectorGraphic>&& graphics) override final {
+    void imageNames(const FnName& fn_name) const override final { context_.imageNames(fn_name); }
+
+    cv::Mat history(const Key& key, const std::size_t frames_back) const override final { return context_.history(key, frames_back); }
+
+    void history(const FrameHistory* frame_history) override final {
+        std::lock_guard lock(mutex_);
+        history_ = frame_history;
+        context_.history(frame_history);
+        for (const auto& camera : cameras()) {
+            std::get<1>(camera)->history(frame_history);
+        }
+    }
+
+    const FrameHistory* history() const override final { return context_.history(); }
+
+    void vectorGraphic(const std::string& image_name, VectorGraphics&& graphics) override final {
         context_.vectorGraphic(image_name, std::move(graphics));
     }
 
-    const std::vector<VectorGraphic>& vectorGraphic(const std::string& image_name) const override final {
+    const VectorGraphics& vectorGraphic(const std::string& image_name) const override final {
         return context_.vectorGraphic(image_name);
     }
 
+    std::pmr::memory_resource& arena() override final { return context_.arena(); }
+
+    std::vector<KeyMemory> memory() const override final {
+        auto memory = context_.memory();
+        forEachCamera([&memory](const std::string& name, ImageContextInterface& context) {
+            for (auto& entry : context.memory()) {
+                entry.camera = name;
+                memory.emplace_back(std::move(entry));
+            }
+        });
+        return memory;
+    }
+
+    std::size_t bytes() const override final {
+        auto bytes = context_.bytes();
+        forEachCamera([&bytes](const std::string&, ImageContextInterface& context) { bytes += context.bytes(); });
+        return bytes;
+    }
+
   private:
-    Cameras cameras_;
+    ImageContextInterface* overflowCamera(const std::string& name) {
+        std::lock_guard lock(mutex_);
+        auto& camera = overflow_[name];
+        if (!camera) {
+            camera = std::make_unique<ImageContext>();
+            camera->frameId(context_.frameId());
+            camera->time(context_.time());
+            for (const auto& [key, fn] : derivations_) {
+                camera->derive(key, fn);
+            }
+        }
+        return camera.get();
+    }
+
+    // every camera's context, including the ones in overflow_
+    template <class Fn>
+    void forEachCamera(const Fn& fn) const {
+        for (const auto& [name, context, id] : cameras()) {
+            fn(name, *context);
+        }
+
+        std::lock_guard lock(mutex_);
+        for (const auto& [name, context] : overflow_) {
+            fn(name, *context);
+        }
+    }
+
+    mutable std::mutex mutex_;
+    std::vector<Camera> cameras_;
+    std::atomic<std::size_t> num_cameras_ = 0;
+    std::array<std::atomic<ImageContextInterface*>, CameraId::max_cameras> table_{};
+    std::unordered_map<std::string, std::unique_ptr<ImageContext>> overflow_;
+    std::vector<std::tuple<Key, FnDerive>> derivations_;
+    const FrameHistory* history_ = nullptr;
     ImageContext context_;
+    MultiImageContextInterface* previous_ = nullptr;
 };
 
 ImageContextInterface::Ptr createImageContext() { return std::make_unique<ImageContext>(); }
@@ -4,14 +4,82 @@
 #include <chrono>
 #include <functional>
 #include <memory>
+#include <memory_resource>
 #include <opencv2/core.hpp>
 #include <string>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "hastings/pipeline/key.h"
+#include "hastings/pipeline/stats.h"
 #include "hastings/pipeline/vector_graphic.h"
 
 namespace hastings {
+class FrameHistory;
+
+// storage for a typed result, cleared in place by the context's clear()
+class TypedResultBase {
+  public:
+    virtual ~TypedResultBase() = default;
+    virtual void clear() = 0;
+
+    // bytes held by the value, its own size plus a container's capacity
+    virtual std::size_t bytes() const = 0;
+};
+
+template <class T>
+class TypedResult final : public TypedResultBase {
+  public:
+    // NOTE(will): pmr containers are made in the frame's arena, so they're emptied without keeping capacity the arena's reset
+    // is about to reclaim. other containers are emptied but keep their capacity, anything without a clear() is reset to a default value.
+    explicit TypedResult(std::pmr::memory_resource& arena) : value(create(arena)) {}
+
+    void clear() override final {
+        if constexpr (uses_arena) {
+            value = T(value.get_allocator());
+        } else if constexpr (HasClear<T>::value) {
+            value.clear();
+        } else {
+            value = T();
+        }
+    }
+
+    std::size_t bytes() const override final {
+        if constexpr (!uses_arena && HasCapacity<T>::value) {
+            return sizeof(T) + value.capacity() * sizeof(typename T::value_type);
+        } else {
+            return sizeof(T);
+        }
+    }
+
+    T value;
+
+  private:
+    static constexpr bool uses_arena = std::uses_allocator_v<T, std::pmr::polymorphic_allocator<std::byte>>;
+
+    static T create(std::pmr::memory_resource& arena) {
+        if constexpr (uses_arena) {
+            return T(std::pmr::polymorphic_allocator<std::byte>(&arena));
+        } else {
+            return T();
+        }
+    }
+
+    template <class U, class = void>
+    struct HasClear : std::false_type {};
+
+    template <class U>
+    struct HasClear<U, std::void_t<decltype(std::declval<U&>().clear())>> : std::true_type {};
+
+    template <class U, class = void>
+    struct HasCapacity : std::false_type {};
+
+    template <class U>
+    struct HasCapacity<U, std::void_t<typename U::value_type, decltype(std::declval<const U&>().capacity())>> : std::true_type {};
+};
+
 class ImageContextInterface {
   public:
     using Clock = std::chrono::steady_clock;
@@ -19,6 +87,9 @@ class ImageContextInterface {
     using Ptr = std::unique_ptr<ImageContextInterface>;
     using FnImage = std::function<void(const std::string&, cv::Mat& image)>;
     using FnConstImage = std::function<void(const std::string&, const cv::Mat& image)>;
+    using FnCreateResult = std::unique_ptr<TypedResultBase> (*)(std::pmr::memory_resource& arena);
+    using FnDerive = std::function<void(ImageContextInterface& context, cv::Mat& image)>;
+    using FnName = std::function<void(const std::string& name)>;
 
     ImageContextInterface() = default;
     virtual ~ImageContextInterface() = default;
@@ -32,32 +103,120 @@ class ImageContextInterface {
     virtual void frameId(const std::size_t& id) = 0;
     virtual std::size_t frameId() const = 0;
 
+    // NOTE(will): string-keyed access interns the name on every call, nodes on the hot path should resolve a Key up front. once
+    // Key::max_keys are taken, names that aren't a Key are kept in the context they're used on instead.
     virtual std::any& result(const std::string& name) = 0;
+    virtual std::any& result(const Key& key) = 0;
 
     virtual cv::Mat& image(const std::string& name) = 0;
+    virtual cv::Mat& image(const Key& key) = 0;
+
+    // NOTE(will): publishes source's image under key without copying it. the two share a buffer until either is written through
+    // image(), which first gives the writer a private copy, so readers of an alias should use view() instead.
+    virtual void alias(const Key& key, ImageContextInterface& source, const Key& source_key) = 0;
+    void alias(const Key& key, const Key& source_key) { alias(key, *this, source_key); }
+
+    // read-only access, never copies a shared image
+    virtual const cv::Mat& view(const std::string& name) = 0;
+    virtual const cv::Mat& view(const Key& key) = 0;
+
+    // marks key's image as shared and returns it, used by alias on the source context
+    virtual const cv::Mat& shareImage(const Key& key) = 0;
+
+    // NOTE(will): fn makes key's image from this context's other images the first time it's accessed in a frame, through image(),
+    // view() or an alias, and it's kept until the frame is cleared. frames where nothing reads it never pay for it. the
+    // registration outlives clear(), a node writing key itself would only have its output made first and overwritten.
+    virtual void derive(const Key& key, const FnDerive& fn) = 0;
+
+    // images made so far this frame, a derived image isn't listed until it's been accessed
     virtual void images(const FnImage& fn_image) = 0;
     virtual void images(const FnConstImage& fn_image) const = 0;
 
-    virtual void vectorGraphic(const std::string& image_name, std::vector<VectorGraphic>&& graphics) = 0;
-    virtual const std::vector<VectorGraphic>& vectorGraphic(const std::string& image_name) const = 0;
+    // names of every image, including derived ones not yet made this frame
+    virtual void imageNames(const FnName& fn_name) const = 0;
+
+    // NOTE(will): key's image from frames_back frames before this one, for keys the pipeline retains. it's empty if that frame isn't
+    // retained anymore or it isn't recorded yet, an ordered writer or a previous-frame input keeps those in order.
+    // the buffer is shared with the frame that made it, so it's read only.
+    virtual cv::Mat history(const Key& key, const std::size_t frames_back) const = 0;
+
+    // set by the pipeline, which prepares a context once and knows it by its history
+    virtual void history(const FrameHistory* frame_history) = 0;
+    virtual const FrameHistory* history() const = 0;
+
+    virtual void vectorGraphic(const std::string& image_name, VectorGraphics&& graphics) = 0;
+    virtual const VectorGraphics& vectorGraphic(const std::string& image_name) const = 0;
+
+    // NOTE(will): scratch memory that lives until the frame is cleared, nodes of the same frame can allocate from it concurrently.
+    // anything allocated from it must be released by clear(), such as a result, a typed pmr result or the frame's graphics.
+    virtual std::pmr::memory_resource& arena() = 0;
+
+    // NOTE(will): bytes held by the images, typed results and arena, meant to be read between frames. a std::any result's size
+    // can't be known so it isn't counted, an alias is left to the context whose image it aliases.
+    virtual std::size_t bytes() const = 0;
+
+    // per-key breakdown of the images & typed results in bytes(), aliases are left out
+    virtual std::vector<KeyMemory> memory() const = 0;
 
     template <class T>
     T& result(const std::string& name) {
         return std::any_cast<T&>(result(name));
     }
+
+    template <class T>
+    T& result(const Key& key) {
+        return std::any_cast<T&>(result(key));
+    }
+
+    template <class T>
+    T& result(const ResultKey<T>& key) {
+        auto& typed = typedResult(key.key(), [](std::pmr::memory_resource& arena) {
+            return std::unique_ptr<TypedResultBase>(std::make_unique<TypedResult<T>>(arena));
+        });
+        return static_cast<TypedResult<T>&>(typed).value;
+    }
+
+    // the typed result for key, made with create on first use. ResultKey ties each key to one type, so the cast above is safe
+    virtual TypedResultBase& typedResult(const Key& key, FnCreateResult create) = 0;
 };
 
 class MultiImageContextInterface : public ImageContextInterface {
   public:
     using Ptr = std::unique_ptr<MultiImageContextInterface>;
-    using Camera = std::tuple<std::string, ImageContextInterface::Ptr>;
-    using Cameras = std::vector<Camera>;
+    using Camera = std::tuple<std::string, ImageContextInterface::Ptr, CameraId>;
+
+    // NOTE(will): the cameras made when it was taken. entries never move, so it stays valid as later ones are made, but doesn't
+    // include them.
+    class Cameras {
+      public:
+        Cameras(const Camera* cameras, const std::size_t size) : cameras_(cameras), size_(size) {}
+
+        const Camera* begin() const { return cameras_; }
+        const Camera* end() const { return cameras_ + size_; }
+        std::size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+        const Camera& operator[](const std::size_t index) const { return cameras_[index]; }
+        const Camera& front() const { return cameras_[0]; }
+
+      private:
+        const Camera* cameras_;
+        std::size_t size_;
+    };
 
     MultiImageContextInterface() = default;
     virtual ~MultiImageContextInterface() = default;
 
+    // NOTE(will): a camera's context is made on first use. cameras registered with the pipeline are made before its first frame,
+    // one made mid-frame is published once it's ready, nodes already iterating cameras() carry on without it. a name past
+    // CameraId::max_cameras still gets a context of its own, but it isn't listed by cameras().
     virtual ImageContextInterface* cameras(const std::string& name) = 0;
-    virtual const Cameras& cameras() const = 0;
+    virtual ImageContextInterface* cameras(const CameraId& camera) = 0;
+    virtual Cameras cameras() const = 0;
+
+    // NOTE(will): the previous frame's context, set by the pipeline when nodes declare previous-frame inputs and nullptr on the
+    // first frame. it stays alive until this frame's readers finish, but only the declared keys are safe to read.
+    virtual MultiImageContextInterface* previous() const = 0;
+    virtual void previous(MultiImageContextInterface* multi_context) = 0;
 };
 
 ImageContextInterface::Ptr createImageContext();
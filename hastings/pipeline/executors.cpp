@@ -1,8 +1,65 @@
 #include "hastings/pipeline/executors.h"
 
+#include <algorithm>
+#include <thread>
+
 #include "hastings/helpers/profile_marker.h"
 
 namespace hastings {
+namespace {
+void runPrepare(NodeInterface& node, MultiImageContextInterface& multi_context, LatencyHistogram& prepare_latency) {
+    ProfilerFunctionMarker marker(node.name());
+    LatencyTimer timer(prepare_latency);
+    node.prepare(multi_context);
+}
+}  // namespace
+
+std::unique_ptr<ExecutorInterface> createExecutor(NodeInterface::Ptr&& node) {
+    if (dynamic_cast<AsyncNodeInterface*>(node.get()) != nullptr) {
+        return std::make_unique<AsyncExecutor>(std::move(node));
+    }
+
+    switch (node->executionPolicy()) {
+        case ExecutionPolicy::Ordered:
+            return std::make_unique<OrderedExecutor>(std::move(node));
+        case ExecutionPolicy::Unordered:
+            return std::make_unique<UnorderedExecutor>(std::move(node));
+        case ExecutionPolicy::Parallel:
+            return std::make_unique<ParallelExecutor>(std::move(node));
+        case ExecutionPolicy::Batched:
+            return std::make_unique<BatchingExecutor>(std::move(node));
+        case ExecutionPolicy::PerCamera:
+            return std::make_unique<PerCameraExecutor>(std::move(node));
+        case ExecutionPolicy::OrderedPerCamera:
+            return std::make_unique<CameraOrderedExecutor>(std::move(node));
+        default:
+            throw std::invalid_argument("unsupported policy");
+    }
+}
+
+void initializeExecutors(const std::vector<ExecutorInterface*>& executors, Scheduler& scheduler) {
+    std::mutex mutex;
+    std::condition_variable cv;
+    auto num_remaining = executors.size();
+
+    for (auto executor : executors) {
+        scheduler.submit([executor, &mutex, &cv, &num_remaining] {
+            executor->initialize();
+
+            std::lock_guard lock(mutex);
+            num_remaining -= 1;
+            cv.notify_all();
+        });
+    }
+
+    std::unique_lock lock(mutex);
+    cv.wait(lock, [&num_remaining] { return num_remaining == 0; });
+}
+
+void ExecutorInterface::schedule(MultiImageContextInterface& multi_context, Scheduler&, FnContinuation&& continuation, FnDropped&&) {
+    process(multi_context);
+    continuation();
+}
 
 ParallelExecutor::ParallelExecutor(Ptr&& node) : node_(std::move(node)) {
     if (node_->executionPolicy() != ExecutionPolicy::Parallel) {
@@ -11,9 +68,14 @@ ParallelExecutor::ParallelExecutor(Ptr&& node) : node_(std::move(node)) {
 }
 
 std::string ParallelExecutor::name() const { return "ParallelExecutor"; }
+std::optional<Dependencies> ParallelExecutor::dependencies() const { return node_->dependencies(); }
+void ParallelExecutor::initialize() { node_->initialize(); }
+NodeStats ParallelExecutor::stats() const { return NodeStats{node_->name(), run_latency_.summary(), {}, {}}; }
 
 void ParallelExecutor::process(MultiImageContextInterface& multi_context) {
     ProfilerFunctionMarker marker(node_->name());
+    LatencyTimer timer(run_latency_);
+    node_->prepare(multi_context);
     node_->process(multi_context);
 }
 
@@ -24,10 +86,62 @@ UnorderedExecutor::UnorderedExecutor(Ptr&& node) : node_(std::move(node)) {
 }
 
 std::string UnorderedExecutor::name() const { return "UnorderedExecutor"; }
+std::optional<Dependencies> UnorderedExecutor::dependencies() const { return node_->dependencies(); }
+void UnorderedExecutor::initialize() { node_->initialize(); }
+NodeStats UnorderedExecutor::stats() const {
+    return NodeStats{node_->name(), run_latency_.summary(), wait_latency_.summary(), prepare_latency_.summary()};
+}
 
 void UnorderedExecutor::process(MultiImageContextInterface& multi_context) {
+    runPrepare(*node_, multi_context, prepare_latency_);
+    execute(multi_context, Clock::now());
+}
+
+void UnorderedExecutor::schedule(MultiImageContextInterface& multi_context, Scheduler& scheduler, FnContinuation&& continuation,
+                                 FnDropped&& is_dropped) {
+    runPrepare(*node_, multi_context, prepare_latency_);
+
+    const auto queued = Clock::now();
+    {
+        std::lock_guard lock(parked_mutex_);
+        if (busy_) {
+            parked_.emplace_back(Parked{&multi_context, std::move(continuation), std::move(is_dropped), queued});
+            return;
+        }
+        busy_ = true;
+    }
+
+    run(multi_context, scheduler, std::move(continuation), queued, false);
+}
+
+void UnorderedExecutor::run(MultiImageContextInterface& multi_context, Scheduler& scheduler, FnContinuation&& continuation,
+                            const Clock::time_point queued, const bool is_dropped) {
+    if (!is_dropped) {
+        execute(multi_context, queued);
+    }
+
+    {
+        std::lock_guard lock(parked_mutex_);
+        if (parked_.empty()) {
+            busy_ = false;
+        } else {
+            scheduler.submit([this, &scheduler, parked = std::move(parked_.front())]() mutable {
+                const auto is_dropped = parked.is_dropped && parked.is_dropped();
+                run(*parked.multi_context, scheduler, std::move(parked.continuation), parked.parked, is_dropped);
+            });
+            parked_.pop_front();
+        }
+    }
+
+    continuation();
+}
+
+void UnorderedExecutor::execute(MultiImageContextInterface& multi_context, const Clock::time_point queued) {
     std::lock_guard lock(mutex_);
+    wait_latency_.record(Clock::now() - queued);
+
     ProfilerFunctionMarker marker(node_->name());
+    LatencyTimer timer(run_latency_);
     node_->process(multi_context);
 }
 
@@ -38,18 +152,694 @@ OrderedExecutor::OrderedExecutor(Ptr&& node) : node_(std::move(node)) {
 };
 
 std::string OrderedExecutor::name() const { return "OrderedExecutor"; }
+std::optional<Dependencies> OrderedExecutor::dependencies() const { return node_->dependencies(); }
+void OrderedExecutor::initialize() { node_->initialize(); }
+NodeStats OrderedExecutor::stats() const {
+    return NodeStats{node_->name(), run_latency_.summary(), wait_latency_.summary(), prepare_latency_.summary()};
+}
 
 void OrderedExecutor::process(MultiImageContextInterface& multi_context) {
-    std::unique_lock lock(mutex_);
-    cv_.wait(lock, [&] { return multi_context.frameId() == frame_id_; });
+    runPrepare(*node_, multi_context, prepare_latency_);
+
+    {
+        LatencyTimer timer(wait_latency_);
+        sequencer_.wait(multi_context.frameId());
+    }
+
+    execute(multi_context);
+    release();
+};
+
+void OrderedExecutor::schedule(MultiImageContextInterface& multi_context, Scheduler& scheduler, FnContinuation&& continuation,
+                               FnDropped&& is_dropped) {
+    runPrepare(*node_, multi_context, prepare_latency_);
+
+    const auto queued = Clock::now();
+    auto resume = [this, &multi_context, &scheduler, continuation, is_dropped, queued]() mutable {
+        scheduler.submit([this, &multi_context, &scheduler, continuation = std::move(continuation), is_dropped = std::move(is_dropped),
+                          queued]() mutable {
+            const auto dropped = is_dropped && is_dropped();
+            run(multi_context, scheduler, std::move(continuation), queued, dropped);
+        });
+    };
+
+    if (sequencer_.park(multi_context.frameId(), std::move(resume))) {
+        run(multi_context, scheduler, std::move(continuation), queued, false);
+    }
+}
+
+void OrderedExecutor::skip(const MultiImageContextInterface& multi_context) {
+    const auto resume = sequencer_.skip(multi_context.frameId());
+    if (resume) {
+        resume();
+    }
+}
+
+void OrderedExecutor::run(MultiImageContextInterface& multi_context, Scheduler&, FnContinuation&& continuation,
+                          const Clock::time_point queued, const bool is_dropped) {
+    wait_latency_.record(Clock::now() - queued);
+
+    if (!is_dropped) {
+        execute(multi_context);
+    }
+    release();
+    continuation();
+}
+
+void OrderedExecutor::execute(MultiImageContextInterface& multi_context) {
+    ProfilerFunctionMarker marker(node_->name());
+    LatencyTimer timer(run_latency_);
+    node_->process(multi_context);
+}
+
+void OrderedExecutor::release() {
+    const auto resume = sequencer_.advance();
+    if (resume) {
+        resume();
+    }
+}
+
+PerCameraExecutor::PerCameraExecutor(Ptr&& node) {
+    if (node->executionPolicy() != ExecutionPolicy::PerCamera || dynamic_cast<CameraNodeInterface*>(node.get()) == nullptr) {
+        throw std::invalid_argument("requires a per-camera processor");
+    }
+
+    node_.reset(static_cast<CameraNodeInterface*>(node.release()));
+}
+
+std::string PerCameraExecutor::name() const { return "PerCameraExecutor"; }
+std::optional<Dependencies> PerCameraExecutor::dependencies() const { return node_->dependencies(); }
+void PerCameraExecutor::initialize() { node_->initialize(); }
+NodeStats PerCameraExecutor::stats() const { return NodeStats{node_->name(), run_latency_.summary(), {}, {}}; }
+
+void PerCameraExecutor::process(MultiImageContextInterface& multi_context) {
+    ProfilerFunctionMarker marker(node_->name());
+    LatencyTimer timer(run_latency_);
+    node_->prepare(multi_context);
+    node_->process(multi_context);
+}
+
+void PerCameraExecutor::schedule(MultiImageContextInterface& multi_context, Scheduler& scheduler, FnContinuation&& continuation,
+                                 FnDropped&&) {
+    const auto& cameras = multi_context.cameras();
+    if (cameras.size() <= 1) {
+        process(multi_context);
+        continuation();
+        return;
+    }
+
+    auto join = std::make_shared<detail::CameraJoin>();
+    join->num_remaining = cameras.size();
+    join->continuation = std::move(continuation);
+    join->start = Clock::now();
+
+    node_->prepare(multi_context);
+
+    // NOTE(will): the first camera runs on this worker.
+    for (auto idx = std::size_t(1); idx < cameras.size(); ++idx) {
+        const auto& [name, context, camera] = cameras[idx];
+        scheduler.submit([this, join, camera = camera, context = context.get()] { run(camera, *context, *join); });
+    }
+
+    const auto& [name, context, camera] = cameras.front();
+    run(camera, *context, *join);
+}
+
+void PerCameraExecutor::run(const CameraId& camera, ImageContextInterface& context, detail::CameraJoin& join) {
+    {
+        ProfilerFunctionMarker marker(node_->name());
+        node_->processCamera(camera, context);
+    }
+
+    if (join.num_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        run_latency_.record(Clock::now() - join.start);
+        join.continuation();
+    }
+}
+
+CameraOrderedExecutor::CameraOrderedExecutor(Ptr&& node) {
+    if (node->executionPolicy() != ExecutionPolicy::OrderedPerCamera || dynamic_cast<CameraNodeInterface*>(node.get()) == nullptr) {
+        throw std::invalid_argument("requires an ordered per-camera processor");
+    }
+
+    node_.reset(static_cast<CameraNodeInterface*>(node.release()));
+}
+
+std::string CameraOrderedExecutor::name() const { return "CameraOrderedExecutor"; }
+std::optional<Dependencies> CameraOrderedExecutor::dependencies() const { return node_->dependencies(); }
+void CameraOrderedExecutor::initialize() { node_->initialize(); }
+NodeStats CameraOrderedExecutor::stats() const {
+    return NodeStats{node_->name(), run_latency_.summary(), wait_latency_.summary(), prepare_latency_.summary()};
+}
+
+void CameraOrderedExecutor::process(MultiImageContextInterface& multi_context) {
+    runPrepare(*node_, multi_context, prepare_latency_);
+
+    {
+        LatencyTimer timer(wait_latency_);
+        sequencer_.wait(multi_context.frameId());
+    }
 
     {
         ProfilerFunctionMarker marker(node_->name());
+        LatencyTimer timer(run_latency_);
         node_->process(multi_context);
-        frame_id_ += 1;
     }
+    release();
+}
+
+void CameraOrderedExecutor::schedule(MultiImageContextInterface& multi_context, Scheduler& scheduler, FnContinuation&& continuation,
+                                     FnDropped&& is_dropped) {
+    runPrepare(*node_, multi_context, prepare_latency_);
+
+    const auto queued = Clock::now();
+    auto resume = [this, &multi_context, &scheduler, continuation, is_dropped, queued]() mutable {
+        scheduler.submit([this, &multi_context, &scheduler, continuation = std::move(continuation), is_dropped = std::move(is_dropped),
+                          queued]() mutable {
+            const auto dropped = is_dropped && is_dropped();
+            dispatch(multi_context, scheduler, std::move(continuation), queued, dropped);
+        });
+    };
+
+    if (sequencer_.park(multi_context.frameId(), std::move(resume))) {
+        dispatch(multi_context, scheduler, std::move(continuation), queued, false);
+    }
+}
+
+void CameraOrderedExecutor::skip(const MultiImageContextInterface& multi_context) {
+    const auto resume = sequencer_.skip(multi_context.frameId());
+    if (resume) {
+        resume();
+    }
+}
+
+void CameraOrderedExecutor::dispatch(MultiImageContextInterface& multi_context, Scheduler& scheduler, FnContinuation&& continuation,
+                                     const Clock::time_point queued, const bool is_dropped) {
+    const auto start = Clock::now();
+    wait_latency_.record(start - queued);
+
+    if (is_dropped) {
+        release();
+        continuation();
+        return;
+    }
+
+    const auto& cameras = multi_context.cameras();
+    if (cameras.empty()) {
+        release();
+        run_latency_.record(Clock::now() - start);
+        continuation();
+        return;
+    }
+
+    auto join = std::make_shared<detail::CameraJoin>();
+    join->num_remaining = cameras.size();
+    join->continuation = std::move(continuation);
+    join->start = start;
+
+    // NOTE(will): strands_ is only touched here, which the sequencer runs one frame at a time in frame order.
+    for (const auto& [name, context, camera] : cameras) {
+        auto& strand = strands_[camera.id()];
+        if (!strand) {
+            strand = std::make_unique<Strand>();
+        }
+
+        post(*strand, scheduler, [this, join, camera = camera, context = context.get()] {
+            {
+                ProfilerFunctionMarker marker(node_->name());
+                node_->processCamera(camera, *context);
+            }
+
+            if (join->num_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                run_latency_.record(Clock::now() - join->start);
+                join->continuation();
+            }
+        });
+    }
+
+    release();
+}
+
+void CameraOrderedExecutor::post(Strand& strand, Scheduler& scheduler, Scheduler::Task&& task) {
+    {
+        std::lock_guard lock(strand.mutex);
+        strand.tasks.emplace_back(std::move(task));
+        if (strand.busy) {
+            return;
+        }
+        strand.busy = true;
+    }
+
+    scheduler.submit([this, &strand] { drain(strand); });
+}
+
+void CameraOrderedExecutor::drain(Strand& strand) {
+    while (true) {
+        Scheduler::Task task;
+        {
+            std::lock_guard lock(strand.mutex);
+            if (strand.tasks.empty()) {
+                strand.busy = false;
+                return;
+            }
+
+            task = std::move(strand.tasks.front());
+            strand.tasks.pop_front();
+        }
+
+        task();
+    }
+}
+
+void CameraOrderedExecutor::release() {
+    const auto resume = sequencer_.advance();
+    if (resume) {
+        resume();
+    }
+}
+
+AsyncExecutor::AsyncExecutor(Ptr&& node) : policy_(node->executionPolicy()) {
+    if (dynamic_cast<AsyncNodeInterface*>(node.get()) == nullptr) {
+        throw std::invalid_argument("requires an async processor");
+    }
+
+    if (policy_ != ExecutionPolicy::Ordered && policy_ != ExecutionPolicy::Unordered && policy_ != ExecutionPolicy::Parallel) {
+        throw std::invalid_argument("unsupported policy for an async processor");
+    }
+
+    node_.reset(static_cast<AsyncNodeInterface*>(node.release()));
+}
+
+std::string AsyncExecutor::name() const { return "AsyncExecutor"; }
+std::optional<Dependencies> AsyncExecutor::dependencies() const { return node_->dependencies(); }
+void AsyncExecutor::initialize() { node_->initialize(); }
+NodeStats AsyncExecutor::stats() const {
+    return NodeStats{node_->name(), run_latency_.summary(), wait_latency_.summary(), prepare_latency_.summary()};
+}
+
+void AsyncExecutor::process(MultiImageContextInterface& multi_context) {
+    runPrepare(*node_, multi_context, prepare_latency_);
 
+    {
+        LatencyTimer timer(wait_latency_);
+        if (policy_ == ExecutionPolicy::Ordered) {
+            sequencer_.wait(multi_context.frameId());
+        } else if (policy_ == ExecutionPolicy::Unordered) {
+            wait();
+        }
+    }
+
+    {
+        ProfilerFunctionMarker marker(node_->name());
+        LatencyTimer timer(run_latency_);
+        node_->process(multi_context);
+    }
+
+    release();
+}
+
+// NOTE(will): process() queues behind scheduled frames in parked_, release() hands busy_ straight on to it like to any of them.
+void AsyncExecutor::wait() {
+    std::unique_lock lock(parked_mutex_);
+    if (!busy_) {
+        busy_ = true;
+        return;
+    }
+
+    bool resumed = false;
+    std::condition_variable cv;
+    parked_.emplace_back([this, &resumed, &cv] {
+        std::lock_guard lock(parked_mutex_);
+        resumed = true;
+        cv.notify_one();
+    });
+    cv.wait(lock, [&resumed] { return resumed; });
+}
+
+void AsyncExecutor::schedule(MultiImageContextInterface& multi_context, Scheduler& scheduler, FnContinuation&& continuation,
+                             FnDropped&& is_dropped) {
+    runPrepare(*node_, multi_context, prepare_latency_);
+
+    const auto queued = Clock::now();
+    auto resume = [this, &multi_context, &scheduler, continuation, is_dropped, queued]() mutable {
+        scheduler.submit([this, &multi_context, &scheduler, continuation = std::move(continuation), is_dropped = std::move(is_dropped),
+                          queued]() mutable {
+            const auto dropped = is_dropped && is_dropped();
+            start(multi_context, scheduler, std::move(continuation), queued, dropped);
+        });
+    };
+
+    if (policy_ == ExecutionPolicy::Ordered) {
+        if (!sequencer_.park(multi_context.frameId(), std::move(resume))) {
+            return;
+        }
+    } else if (policy_ == ExecutionPolicy::Unordered) {
+        std::lock_guard lock(parked_mutex_);
+        if (busy_) {
+            parked_.emplace_back(std::move(resume));
+            return;
+        }
+        busy_ = true;
+    }
+
+    start(multi_context, scheduler, std::move(continuation), queued, false);
+}
+
+void AsyncExecutor::skip(const MultiImageContextInterface& multi_context) {
+    if (policy_ != ExecutionPolicy::Ordered) {
+        return;
+    }
+
+    const auto resume = sequencer_.skip(multi_context.frameId());
+    if (resume) {
+        resume();
+    }
+}
+
+void AsyncExecutor::start(MultiImageContextInterface& multi_context, Scheduler& scheduler, FnContinuation&& continuation,
+                          const Clock::time_point queued, const bool is_dropped) {
+    const auto started = Clock::now();
+    wait_latency_.record(started - queued);
+
+    if (is_dropped) {
+        release();
+        continuation();
+        return;
+    }
+
+    // NOTE(will): done may be called on the node's own I/O thread, so the continuation is handed back to the worker pool.
+    ProfilerFunctionMarker marker(node_->name());
+    node_->processAsync(multi_context, [this, &scheduler, continuation = std::move(continuation), started]() mutable {
+        run_latency_.record(Clock::now() - started);
+        release();
+        scheduler.submit(std::move(continuation));
+    });
+}
+
+void AsyncExecutor::release() {
+    Scheduler::Task resume;
+    if (policy_ == ExecutionPolicy::Ordered) {
+        resume = sequencer_.advance();
+    } else if (policy_ == ExecutionPolicy::Unordered) {
+        std::lock_guard lock(parked_mutex_);
+        if (parked_.empty()) {
+            busy_ = false;
+        } else {
+            resume = std::move(parked_.front());
+            parked_.pop_front();
+        }
+    }
+
+    if (resume) {
+        resume();
+    }
+}
+
+ReplicatedExecutor::ReplicatedExecutor(Replicas&& replicas) : replicas_(std::move(replicas)) {
+    if (replicas_.empty() || replicas_.size() > max_replicas) {
+        throw std::invalid_argument("requires between 1 and 64 replicas");
+    }
+
+    for (const auto& replica : replicas_) {
+        if (replica == nullptr || replica->executionPolicy() != ExecutionPolicy::Unordered) {
+            throw std::invalid_argument("requires unordered replicas");
+        }
+    }
+
+    free_ = replicas_.size() == max_replicas ? ~std::uint64_t(0) : (std::uint64_t(1) << replicas_.size()) - 1;
+}
+
+std::string ReplicatedExecutor::name() const { return "ReplicatedExecutor"; }
+std::optional<Dependencies> ReplicatedExecutor::dependencies() const { return replicas_.front()->dependencies(); }
+void ReplicatedExecutor::initialize() {
+    for (const auto& replica : replicas_) {
+        replica->initialize();
+    }
+}
+NodeStats ReplicatedExecutor::stats() const {
+    return NodeStats{replicas_.front()->name(), run_latency_.summary(), wait_latency_.summary(), {}};
+}
+
+void ReplicatedExecutor::process(MultiImageContextInterface& multi_context) {
+    const auto queued = Clock::now();
+
+    auto replica = acquire();
+    if (!replica.has_value()) {
+        std::unique_lock lock(parked_mutex_);
+        num_waiting_ += 1;
+        released_.wait(lock, [this, &replica] { return (replica = acquire()).has_value(); });
+        num_waiting_ -= 1;
+    }
+
+    execute(*replica, multi_context, queued);
+    release(*replica);
+}
+
+void ReplicatedExecutor::schedule(MultiImageContextInterface& multi_context, Scheduler& scheduler, FnContinuation&& continuation,
+                                  FnDropped&& is_dropped) {
+    const auto queued = Clock::now();
+
+    if (const auto replica = acquire()) {
+        execute(*replica, multi_context, queued);
+        release(*replica);
+        continuation();
+        return;
+    }
+
+    {
+        std::lock_guard lock(parked_mutex_);
+        parked_.emplace_back(Parked{&multi_context, std::move(continuation), std::move(is_dropped), &scheduler, queued});
+        num_parked_ += 1;
+    }
+
+    // NOTE(will): a replica may have been freed between the failed acquire and parking, nobody else would pick it up.
+    drain();
+}
+
+std::optional<std::size_t> ReplicatedExecutor::acquire() {
+    auto mask = free_.load();
+    while (mask != 0) {
+        const auto replica = std::size_t(__builtin_ctzll(mask));
+        if (free_.compare_exchange_weak(mask, mask & ~(std::uint64_t(1) << replica))) {
+            return replica;
+        }
+    }
+
+    return std::nullopt;
+}
+
+void ReplicatedExecutor::release(const std::size_t replica) {
+    free(replica);
+    drain();
+}
+
+// NOTE(will): a blocked process() either sees the freed bit in its acquire or is counted in num_waiting_ before it sleeps.
+void ReplicatedExecutor::free(const std::size_t replica) {
+    free_.fetch_or(std::uint64_t(1) << replica);
+    if (num_waiting_ > 0) {
+        std::lock_guard lock(parked_mutex_);
+        released_.notify_all();
+    }
+}
+
+void ReplicatedExecutor::drain() {
+    while (num_parked_ > 0) {
+        const auto replica = acquire();
+        if (!replica.has_value()) {
+            return;
+        }
+
+        std::optional<Parked> parked;
+        {
+            std::lock_guard lock(parked_mutex_);
+            if (!parked_.empty()) {
+                parked.emplace(std::move(parked_.front()));
+                parked_.pop_front();
+                num_parked_ -= 1;
+            }
+        }
+
+        if (!parked.has_value()) {
+            free(*replica);
+            continue;
+        }
+
+        parked->scheduler->submit([this, replica = *replica, parked = std::move(*parked)]() mutable {
+            if (!parked.is_dropped || !parked.is_dropped()) {
+                execute(replica, *parked.multi_context, parked.parked);
+            }
+            release(replica);
+            parked.continuation();
+        });
+    }
+}
+
+void ReplicatedExecutor::execute(const std::size_t replica, MultiImageContextInterface& multi_context, const Clock::time_point queued) {
+    wait_latency_.record(Clock::now() - queued);
+
+    const auto& node = replicas_[replica];
+    ProfilerFunctionMarker marker(node->name());
+    LatencyTimer timer(run_latency_);
+    node->prepare(multi_context);
+    node->process(multi_context);
+}
+
+BatchingExecutor::BatchingExecutor(Ptr&& node) : batch_(std::make_shared<Batch>()) {
+    if (node->executionPolicy() != ExecutionPolicy::Batched || dynamic_cast<BatchNodeInterface*>(node.get()) == nullptr) {
+        throw std::invalid_argument("requires a batched processor");
+    }
+
+    node_.reset(static_cast<BatchNodeInterface*>(node.release()));
+    if (node_->batchSize() == 0) {
+        throw std::invalid_argument("requires a non-zero batch size");
+    }
+
+    timer_ = std::thread([this] { expire(); });
+}
+
+BatchingExecutor::~BatchingExecutor() {
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    timer_.join();
+}
+
+std::string BatchingExecutor::name() const { return "BatchingExecutor"; }
+std::optional<Dependencies> BatchingExecutor::dependencies() const { return node_->dependencies(); }
+void BatchingExecutor::initialize() { node_->initialize(); }
+NodeStats BatchingExecutor::stats() const { return NodeStats{node_->name(), run_latency_.summary(), wait_latency_.summary(), {}}; }
+
+void BatchingExecutor::process(MultiImageContextInterface& multi_context) {
+    node_->prepare(multi_context);
+
+    const auto batch = enqueue(Pending{&multi_context, {}, nullptr, Clock::now()});
+
+    std::unique_lock lock(mutex_);
+    cv_.wait(lock, [&batch] { return batch->done; });
+}
+
+void BatchingExecutor::schedule(MultiImageContextInterface& multi_context, Scheduler& scheduler, FnContinuation&& continuation,
+                                FnDropped&&) {
+    node_->prepare(multi_context);
+    enqueue(Pending{&multi_context, std::move(continuation), &scheduler, Clock::now()});
+}
+
+std::shared_ptr<BatchingExecutor::Batch> BatchingExecutor::enqueue(Pending&& pending) {
+    std::unique_lock lock(mutex_);
+
+    auto batch = batch_;
+    batch->pending.emplace_back(std::move(pending));
+
+    const auto is_leader = batch->pending.size() == 1;
+    if (batch->pending.size() < node_->batchSize()) {
+        if (!is_leader) {
+            return batch;
+        }
+
+        batch->deadline = Clock::now() + node_->batchTimeout();
+        if (batch->pending.front().scheduler != nullptr) {
+            lock.unlock();
+            cv_.notify_all();
+            return batch;
+        }
+
+        cv_.wait_until(lock, batch->deadline, [this, &batch] { return batch_ != batch; });
+        if (batch_ != batch) {
+            return batch;
+        }
+    }
+
+    batch_ = std::make_shared<Batch>();
     lock.unlock();
     cv_.notify_all();
-};
-}  // namespace hastings
\ No newline at end of file
+
+    run(batch);
+    return batch;
+}
+
+void BatchingExecutor::expire() {
+    std::unique_lock lock(mutex_);
+    while (!stop_) {
+        const auto batch = batch_;
+        if (batch->pending.empty() || batch->pending.front().scheduler == nullptr) {
+            cv_.wait(lock, [this, &batch] {
+                return stop_ || batch_ != batch || (!batch_->pending.empty() && batch_->pending.front().scheduler != nullptr);
+            });
+            continue;
+        }
+
+        if (cv_.wait_until(lock, batch->deadline, [this, &batch] { return stop_ || batch_ != batch; })) {
+            continue;
+        }
+
+        batch_ = std::make_shared<Batch>();
+        const auto scheduler = batch->pending.front().scheduler;
+        lock.unlock();
+
+        scheduler->submit([this, batch] { run(batch); });
+        lock.lock();
+    }
+}
+
+// NOTE(will): the node runs one batch at a time. a batch filled meanwhile is queued for the thread running the node instead of
+// blocking its own, which for a scheduled frame would be a worker.
+void BatchingExecutor::run(std::shared_ptr<Batch> batch) {
+    {
+        std::lock_guard lock(mutex_);
+        ready_.emplace_back(std::move(batch));
+        if (running_) {
+            return;
+        }
+        running_ = true;
+    }
+
+    while (true) {
+        {
+            std::lock_guard lock(mutex_);
+            if (ready_.empty()) {
+                running_ = false;
+                return;
+            }
+            batch = std::move(ready_.front());
+            ready_.pop_front();
+        }
+        flush(*batch);
+    }
+}
+
+void BatchingExecutor::flush(Batch& batch) {
+    std::sort(batch.pending.begin(), batch.pending.end(),
+              [](const Pending& lhs, const Pending& rhs) { return lhs.multi_context->frameId() < rhs.multi_context->frameId(); });
+
+    BatchNodeInterface::Batch contexts;
+    contexts.reserve(batch.pending.size());
+    for (const auto& pending : batch.pending) {
+        contexts.emplace_back(pending.multi_context);
+    }
+
+    {
+        const auto now = Clock::now();
+        for (const auto& pending : batch.pending) {
+            wait_latency_.record(now - pending.queued);
+        }
+
+        ProfilerFunctionMarker marker(node_->name());
+        LatencyTimer timer(run_latency_);
+        node_->processBatch(contexts);
+    }
+
+    {
+        std::lock_guard lock(mutex_);
+        batch.done = true;
+    }
+    cv_.notify_all();
+
+    for (auto& pending : batch.pending) {
+        if (pending.scheduler != nullptr) {
+            pending.scheduler->submit(std::move(pending.continuation));
+        }
+    }
+}
+}  // namespace hastings
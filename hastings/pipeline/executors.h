@@ -1,28 +1,68 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "hastings/pipeline/node.h"
+#include "hastings/pipeline/scheduler.h"
+#include "hastings/pipeline/sequencer.h"
+#include "hastings/pipeline/stats.h"
 
 namespace hastings {
 
 class ExecutorInterface : public NodeInterface {
   public:
+    using Clock = std::chrono::steady_clock;
+    using FnContinuation = std::function<void()>;
+    using FnDropped = std::function<bool()>;
+
     ExecutionPolicy executionPolicy() const final { return ExecutionPolicy::Parallel; }
+
+    // NOTE(will): non-blocking counterpart of process, if the node can't take the frame yet it's parked and resumed on the scheduler
+    // later instead of holding the calling thread. continuation is called once the node has processed multi_context. a parked frame
+    // asks is_dropped again when it's resumed, and is skipped rather than processed if it has been dropped meanwhile.
+    virtual void schedule(MultiImageContextInterface& multi_context, Scheduler& scheduler, FnContinuation&& continuation,
+                          FnDropped&& is_dropped = {});
+
+    // called instead of process for frames the pipeline has dropped, so the executor can account for the frame without running it
+    virtual void skip(const MultiImageContextInterface&) {}
+
+    // executors forward to the node(s) they wrap
+    void initialize() override = 0;
+
+    virtual NodeStats stats() const = 0;
 };
 
+// wraps node in the executor matching its execution policy
+std::unique_ptr<ExecutorInterface> createExecutor(NodeInterface::Ptr&& node);
+
+// runs initialize on every executor concurrently across the scheduler's workers, returns once they've all finished
+void initializeExecutors(const std::vector<ExecutorInterface*>& executors, Scheduler& scheduler);
+
 class ParallelExecutor final : public ExecutorInterface {
   public:
     explicit ParallelExecutor(Ptr&& node);
 
     std::string name() const final;
+    std::optional<Dependencies> dependencies() const final;
+    void initialize() final;
+    NodeStats stats() const final;
 
     void process(MultiImageContextInterface& multi_context) final;
 
   private:
+    LatencyHistogram run_latency_;
     Ptr node_;
 };
 
@@ -31,11 +71,33 @@ class UnorderedExecutor final : public ExecutorInterface {
     explicit UnorderedExecutor(Ptr&& node);
 
     std::string name() const final;
+    std::optional<Dependencies> dependencies() const final;
+    void initialize() final;
+    NodeStats stats() const final;
 
     void process(MultiImageContextInterface& multi_context) final;
+    void schedule(MultiImageContextInterface& multi_context, Scheduler& scheduler, FnContinuation&& continuation,
+                  FnDropped&& is_dropped = {}) final;
 
   private:
+    struct Parked {
+        MultiImageContextInterface* multi_context;
+        FnContinuation continuation;
+        FnDropped is_dropped;
+        Clock::time_point parked;
+    };
+
+    void run(MultiImageContextInterface& multi_context, Scheduler& scheduler, FnContinuation&& continuation, const Clock::time_point queued,
+             const bool is_dropped);
+    void execute(MultiImageContextInterface& multi_context, const Clock::time_point queued);
+
     std::mutex mutex_;
+    std::mutex parked_mutex_;
+    bool busy_ = false;
+    std::deque<Parked> parked_;
+    LatencyHistogram run_latency_;
+    LatencyHistogram wait_latency_;
+    LatencyHistogram prepare_latency_;
     Ptr node_;
 };
 
@@ -44,13 +106,214 @@ class OrderedExecutor final : public ExecutorInterface {
     explicit OrderedExecutor(Ptr&& node);
 
     std::string name() const final;
+    std::optional<Dependencies> dependencies() const final;
+    void initialize() final;
+    NodeStats stats() const final;
 
     void process(MultiImageContextInterface& multi_context) final;
+    void schedule(MultiImageContextInterface& multi_context, Scheduler& scheduler, FnContinuation&& continuation,
+                  FnDropped&& is_dropped = {}) final;
+    void skip(const MultiImageContextInterface& multi_context) final;
 
   private:
+    void run(MultiImageContextInterface& multi_context, Scheduler& scheduler, FnContinuation&& continuation, const Clock::time_point queued,
+             const bool is_dropped);
+    void execute(MultiImageContextInterface& multi_context);
+    void release();
+
+    Sequencer sequencer_;
+    LatencyHistogram run_latency_;
+    LatencyHistogram wait_latency_;
+    LatencyHistogram prepare_latency_;
+    Ptr node_;
+};
+
+namespace detail {
+// joins the per-camera tasks of one frame, the last camera to finish runs the continuation
+struct CameraJoin {
+    std::atomic<std::size_t> num_remaining;
+    ExecutorInterface::FnContinuation continuation;
+    ExecutorInterface::Clock::time_point start;
+};
+}  // namespace detail
+
+class PerCameraExecutor final : public ExecutorInterface {
+  public:
+    explicit PerCameraExecutor(Ptr&& node);
+
+    std::string name() const final;
+    std::optional<Dependencies> dependencies() const final;
+    void initialize() final;
+    NodeStats stats() const final;
+
+    void process(MultiImageContextInterface& multi_context) final;
+    void schedule(MultiImageContextInterface& multi_context, Scheduler& scheduler, FnContinuation&& continuation,
+                  FnDropped&& is_dropped = {}) final;
+
+  private:
+    void run(const CameraId& camera, ImageContextInterface& context, detail::CameraJoin& join);
+
+    LatencyHistogram run_latency_;
+    std::unique_ptr<CameraNodeInterface> node_;
+};
+
+// NOTE(will): frames are dispatched in order through a sequencer, each camera then queues its work on its own strand, so frames
+// stay ordered per camera without one camera waiting on another.
+class CameraOrderedExecutor final : public ExecutorInterface {
+  public:
+    explicit CameraOrderedExecutor(Ptr&& node);
+
+    std::string name() const final;
+    std::optional<Dependencies> dependencies() const final;
+    void initialize() final;
+    NodeStats stats() const final;
+
+    void process(MultiImageContextInterface& multi_context) final;
+    void schedule(MultiImageContextInterface& multi_context, Scheduler& scheduler, FnContinuation&& continuation,
+                  FnDropped&& is_dropped = {}) final;
+    void skip(const MultiImageContextInterface& multi_context) final;
+
+  private:
+    struct Strand {
+        std::mutex mutex;
+        std::deque<Scheduler::Task> tasks;
+        bool busy = false;
+    };
+
+    void dispatch(MultiImageContextInterface& multi_context, Scheduler& scheduler, FnContinuation&& continuation,
+                  const Clock::time_point queued, const bool is_dropped);
+    void post(Strand& strand, Scheduler& scheduler, Scheduler::Task&& task);
+    void drain(Strand& strand);
+    void release();
+
+    Sequencer sequencer_;
+    std::array<std::unique_ptr<Strand>, CameraId::max_cameras> strands_;
+    LatencyHistogram run_latency_;
+    LatencyHistogram wait_latency_;
+    LatencyHistogram prepare_latency_;
+    std::unique_ptr<CameraNodeInterface> node_;
+};
+
+class AsyncExecutor final : public ExecutorInterface {
+  public:
+    explicit AsyncExecutor(Ptr&& node);
+
+    std::string name() const final;
+    std::optional<Dependencies> dependencies() const final;
+    void initialize() final;
+    NodeStats stats() const final;
+
+    void process(MultiImageContextInterface& multi_context) final;
+    void schedule(MultiImageContextInterface& multi_context, Scheduler& scheduler, FnContinuation&& continuation,
+                  FnDropped&& is_dropped = {}) final;
+    void skip(const MultiImageContextInterface& multi_context) final;
+
+  private:
+    void start(MultiImageContextInterface& multi_context, Scheduler& scheduler, FnContinuation&& continuation,
+               const Clock::time_point queued, const bool is_dropped);
+    void wait();
+    void release();
+
+    ExecutionPolicy policy_;
+    Sequencer sequencer_;
+    std::mutex parked_mutex_;
+    bool busy_ = false;
+    std::deque<Scheduler::Task> parked_;
+    LatencyHistogram run_latency_;
+    LatencyHistogram wait_latency_;
+    LatencyHistogram prepare_latency_;
+    std::unique_ptr<AsyncNodeInterface> node_;
+};
+
+// NOTE(will): unordered nodes that are only thread-unsafe (scratch buffers, execution contexts), each call borrows a free replica
+// from a lock-free bitmask so up to num replicas frames run the node concurrently. frames wait in parked_ when every replica is busy.
+class ReplicatedExecutor final : public ExecutorInterface {
+  public:
+    using Replicas = std::vector<Ptr>;
+    static constexpr std::size_t max_replicas = 64;
+
+    explicit ReplicatedExecutor(Replicas&& replicas);
+
+    std::string name() const final;
+    std::optional<Dependencies> dependencies() const final;
+    void initialize() final;
+    NodeStats stats() const final;
+
+    void process(MultiImageContextInterface& multi_context) final;
+    void schedule(MultiImageContextInterface& multi_context, Scheduler& scheduler, FnContinuation&& continuation,
+                  FnDropped&& is_dropped = {}) final;
+
+  private:
+    struct Parked {
+        MultiImageContextInterface* multi_context;
+        FnContinuation continuation;
+        FnDropped is_dropped;
+        Scheduler* scheduler;
+        Clock::time_point parked;
+    };
+
+    std::optional<std::size_t> acquire();
+    void release(const std::size_t replica);
+    void free(const std::size_t replica);
+    void drain();
+    void execute(const std::size_t replica, MultiImageContextInterface& multi_context, const Clock::time_point queued);
+
+    std::atomic<std::uint64_t> free_;
+    std::atomic<std::size_t> num_parked_ = 0;
+    std::atomic<std::size_t> num_waiting_ = 0;
+    std::mutex parked_mutex_;
+    std::condition_variable released_;
+    std::deque<Parked> parked_;
+    LatencyHistogram run_latency_;
+    LatencyHistogram wait_latency_;
+    Replicas replicas_;
+};
+
+// NOTE(will): a scheduled frame is parked in the open batch, whichever frame fills it runs it. a batch led by a scheduled frame that
+// doesn't fill up in time is handed to the scheduler by the executor's timer thread, a batch led by process() is run by that caller.
+class BatchingExecutor final : public ExecutorInterface {
+  public:
+    explicit BatchingExecutor(Ptr&& node);
+    ~BatchingExecutor();
+
+    std::string name() const final;
+    std::optional<Dependencies> dependencies() const final;
+    void initialize() final;
+    NodeStats stats() const final;
+
+    void process(MultiImageContextInterface& multi_context) final;
+    void schedule(MultiImageContextInterface& multi_context, Scheduler& scheduler, FnContinuation&& continuation,
+                  FnDropped&& is_dropped = {}) final;
+
+  private:
+    struct Pending {
+        MultiImageContextInterface* multi_context;
+        FnContinuation continuation;
+        Scheduler* scheduler;
+        Clock::time_point queued;
+    };
+
+    struct Batch {
+        std::vector<Pending> pending;
+        Clock::time_point deadline;
+        bool done = false;
+    };
+
+    std::shared_ptr<Batch> enqueue(Pending&& pending);
+    void run(std::shared_ptr<Batch> batch);
+    void flush(Batch& batch);
+    void expire();
+
     std::mutex mutex_;
     std::condition_variable cv_;
-    std::size_t frame_id_ = 0;
-    Ptr node_;
+    std::shared_ptr<Batch> batch_;
+    bool stop_ = false;
+    // full batches waiting on the one running, whoever runs it runs them next
+    std::deque<std::shared_ptr<Batch>> ready_;
+    bool running_ = false;
+    LatencyHistogram run_latency_;
+    LatencyHistogram wait_latency_;
+    std::unique_ptr<BatchNodeInterface> node_;
+    std::thread timer_;
 };
-}  // namespace hastings
\ No newline at end of file
+}  // namespace hastings
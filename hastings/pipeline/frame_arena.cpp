@@ -0,0 +1,94 @@
+#include "hastings/pipeline/frame_arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace hastings {
+namespace {
+constexpr std::size_t block_alignment = alignof(std::max_align_t);
+
+constexpr std::size_t alignUp(const std::size_t value, const std::size_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+}  // namespace
+
+char* FrameArena::Block::data() { return reinterpret_cast<char*>(this) + alignUp(sizeof(Block), block_alignment); }
+
+FrameArena::FrameArena(const std::size_t initial_size) : initial_size_(initial_size) {}
+
+FrameArena::~FrameArena() { destroyBlocks(current_.load()); }
+
+void FrameArena::reset() {
+    std::lock_guard lock(mutex_);
+    const auto block = current_.load(std::memory_order_relaxed);
+    if (block == nullptr) {
+        return;
+    }
+
+    if (block->next == nullptr) {
+        block->offset.store(0, std::memory_order_relaxed);
+        return;
+    }
+
+    destroyBlocks(block);
+    current_.store(createBlock(capacity_), std::memory_order_release);
+}
+
+std::size_t FrameArena::capacity() const {
+    std::lock_guard lock(mutex_);
+    return capacity_;
+}
+
+void* FrameArena::do_allocate(const std::size_t bytes, const std::size_t alignment) {
+    // NOTE(will): sizes are rounded so offsets stay aligned to the block's alignment, only over-aligned requests need padding.
+    const auto padded = alignment <= block_alignment ? alignUp(std::max<std::size_t>(bytes, 1), block_alignment) : bytes + alignment;
+
+    auto block = current_.load(std::memory_order_acquire);
+    while (true) {
+        if (block != nullptr) {
+            const auto offset = block->offset.fetch_add(padded, std::memory_order_relaxed);
+            if (offset + padded <= block->size) {
+                const auto address = reinterpret_cast<std::uintptr_t>(block->data() + offset);
+                return reinterpret_cast<void*>(alignUp(address, alignment));
+            }
+        }
+
+        block = grow(block, padded);
+    }
+}
+
+FrameArena::Block* FrameArena::grow(Block* full, const std::size_t bytes) {
+    std::lock_guard lock(mutex_);
+    const auto block = current_.load(std::memory_order_relaxed);
+    if (block != full) {
+        return block;
+    }
+
+    const auto size = std::max(block != nullptr ? block->size * 2 : initial_size_, bytes);
+    const auto created = createBlock(size);
+    created->next = block;
+    capacity_ += size;
+    current_.store(created, std::memory_order_release);
+    return created;
+}
+
+FrameArena::Block* FrameArena::createBlock(const std::size_t size) {
+    const auto memory = std::malloc(alignUp(sizeof(Block), block_alignment) + size);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    const auto block = new (memory) Block();
+    block->size = size;
+    return block;
+}
+
+void FrameArena::destroyBlocks(Block* block) {
+    while (block != nullptr) {
+        const auto next = block->next;
+        block->~Block();
+        std::free(block);
+        block = next;
+    }
+}
+}  // namespace hastings
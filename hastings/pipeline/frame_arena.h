@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+
+namespace hastings {
+// NOTE(will): a monotonic memory resource for a frame's short-lived allocations. allocating is an atomic bump of the current
+// block's offset, so nodes of the same frame can share it, and deallocating does nothing. reset frees everything at once, if a frame
+// needed more than one block they're replaced by a single block big enough for all of them, so a steady-state frame never allocates.
+class FrameArena final : public std::pmr::memory_resource {
+  public:
+    explicit FrameArena(std::size_t initial_size = 64 * 1024);
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // must not run alongside allocations, nothing allocated before it may be used after
+    void reset();
+
+    // bytes held in blocks, used or not
+    std::size_t capacity() const;
+
+  private:
+    struct Block {
+        Block* next = nullptr;
+        std::size_t size = 0;
+        std::atomic<std::size_t> offset = 0;
+
+        char* data();
+    };
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override final;
+    void do_deallocate(void*, std::size_t, std::size_t) override final {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override final { return this == &other; }
+
+    Block* grow(Block* full, std::size_t bytes);
+    static Block* createBlock(std::size_t size);
+    static void destroyBlocks(Block* block);
+
+    std::size_t initial_size_;
+    std::atomic<Block*> current_ = nullptr;
+
+    mutable std::mutex mutex_;
+    std::size_t capacity_ = 0;
+};
+}  // namespace hastings
@@ -0,0 +1,152 @@
+#include "hastings/pipeline/frame_history.h"
+
+#include <algorithm>
+
+namespace hastings {
+FrameHistory::~FrameHistory() {
+    for (auto& ring : rings_) {
+        delete ring.load();
+    }
+}
+
+void FrameHistory::retain(const Key& key, const std::size_t num_frames) {
+    std::lock_guard lock(mutex_);
+    auto ring = rings_[key.id()].load(std::memory_order_relaxed);
+    if (ring == nullptr) {
+        ring = new Ring();
+        rings_[key.id()].store(ring, std::memory_order_release);
+        retained_.emplace_back(ring);
+    }
+
+    std::lock_guard ring_lock(ring->mutex);
+    resize(*ring, num_frames, in_flight_);
+}
+
+void FrameHistory::inFlight(const std::size_t num_frames) {
+    std::lock_guard lock(mutex_);
+    in_flight_ = std::max(num_frames, std::size_t(1));
+    for (auto& ring : rings_) {
+        if (const auto retained = ring.load(std::memory_order_relaxed); retained != nullptr) {
+            std::lock_guard ring_lock(retained->mutex);
+            resize(*retained, retained->num_frames, in_flight_);
+        }
+    }
+}
+
+void FrameHistory::resize(Ring& ring, const std::size_t num_frames, const std::size_t in_flight) {
+    ring.num_frames = num_frames;
+
+    // NOTE(will): entries sit at frame_id % size, a different size moves them all so they're dropped.
+    const auto size = num_frames == 0 ? 0 : num_frames + in_flight;
+    if (ring.size != size) {
+        ring.size = size;
+        for (auto& entries : ring.entries) {
+            entries.clear();
+        }
+    }
+}
+
+FrameHistory::Recorders FrameHistory::recorders(const std::vector<Key>& retained,
+                                                const std::vector<std::optional<Dependencies>>& dependencies) {
+    Recorders recorders;
+    recorders.nodes.resize(dependencies.size());
+
+    for (const auto& key : retained) {
+        std::optional<std::size_t> last_writer;
+        auto is_undeclared_after = false;
+        for (auto index = std::size_t(0); index < dependencies.size(); ++index) {
+            const auto& writes = dependencies[index];
+            if (!writes.has_value()) {
+                is_undeclared_after = true;
+            } else if (std::find(writes->outputs.begin(), writes->outputs.end(), key.name()) != writes->outputs.end()) {
+                last_writer = index;
+                is_undeclared_after = false;
+            }
+        }
+
+        if (last_writer.has_value() && !is_undeclared_after) {
+            recorders.nodes[last_writer.value()].emplace_back(key);
+        } else {
+            recorders.frame.emplace_back(key);
+        }
+    }
+    return recorders;
+}
+
+void FrameHistory::record(MultiImageContextInterface& multi_context, const Key& key) {
+    const auto ring = rings_[key.id()].load(std::memory_order_acquire);
+    if (ring == nullptr) {
+        return;
+    }
+
+    const auto frame_id = multi_context.frameId();
+    record(*ring, frame_index, multi_context, key, frame_id);
+    for (const auto& [name, context, camera] : multi_context.cameras()) {
+        record(*ring, camera.id() + 1, *context, key, frame_id);
+    }
+}
+
+cv::Mat FrameHistory::image(const std::size_t index, const Key& key, const std::uint64_t frame_id) const {
+    const auto ring = rings_[key.id()].load(std::memory_order_acquire);
+    if (ring == nullptr) {
+        return cv::Mat();
+    }
+
+    std::lock_guard lock(ring->mutex);
+    const auto& entries = ring->entries[index];
+    if (entries.empty()) {
+        return cv::Mat();
+    }
+
+    const auto& entry = entries[frame_id % entries.size()];
+    return entry.frame_id == frame_id ? entry.image : cv::Mat();
+}
+
+std::size_t FrameHistory::bytes() const {
+    std::size_t bytes = 0;
+
+    std::lock_guard lock(mutex_);
+    for (const auto ring : retained_) {
+        std::lock_guard ring_lock(ring->mutex);
+        for (const auto& entries : ring->entries) {
+            for (const auto& entry : entries) {
+                const auto u = entry.image.u;
+                if (u != nullptr && CV_XADD(&u->refcount, 0) == 1) {
+                    bytes += u->size;
+                }
+            }
+        }
+    }
+    return bytes;
+}
+
+void FrameHistory::record(Ring& ring, const std::size_t index, ImageContextInterface& context, const Key& key,
+                          const std::uint64_t frame_id) {
+    const auto& image = context.shareImage(key);
+    if (image.empty()) {
+        return;
+    }
+
+    // NOTE(will): the image being let go may be the last reference to its buffer, it goes back to the pool outside the lock.
+    cv::Mat released;
+    {
+        std::lock_guard lock(ring.mutex);
+        if (ring.size == 0) {
+            return;
+        }
+
+        auto& entries = ring.entries[index];
+        entries.resize(ring.size);
+
+        // frames can finish out of order, a late one mustn't replace the newer frame now in its place
+        auto& entry = entries[frame_id % ring.size];
+        if (entry.frame_id != std::numeric_limits<std::uint64_t>::max() && entry.frame_id > frame_id) {
+            return;
+        }
+
+        released = std::move(entry.image);
+        entry.frame_id = frame_id;
+        entry.image = image;
+    }
+}
+}  // namespace hastings
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <opencv2/core.hpp>
+#include <optional>
+#include <vector>
+
+#include "hastings/pipeline/context.h"
+#include "hastings/pipeline/key.h"
+#include "hastings/pipeline/node.h"
+
+namespace hastings {
+// NOTE(will): images of retained keys from the last few frames, sharing the buffer of the frame that made them instead of copying
+// it. each key keeps a ring of entries per camera indexed by frame id, so a frame's image is let go, back to the frame pool, once
+// a later frame records over it. a writer can be as many frames ahead of a reader as the pipeline has in flight, so the ring
+// holds those on top of the retained frames.
+class FrameHistory {
+  public:
+    // index of the frame's own context, cameras follow at their id + 1
+    static constexpr std::size_t frame_index = 0;
+    static constexpr std::size_t num_indices = CameraId::max_cameras + 1;
+
+    // NOTE(will): a retained key is recorded once, after the last node declaring it as an output, so later writers don't copy the
+    // shared image and readers don't see it half written. a key only nodes without declarations may write, or one they may write
+    // after its last declared writer, is recorded as the frame finishes instead.
+    struct Recorders {
+        // retained keys each node records once it's done with a frame, indexed like the nodes
+        std::vector<std::vector<Key>> nodes;
+        std::vector<Key> frame;
+    };
+
+    static Recorders recorders(const std::vector<Key>& retained, const std::vector<std::optional<Dependencies>>& dependencies);
+
+    FrameHistory() = default;
+    ~FrameHistory();
+
+    FrameHistory(const FrameHistory&) = delete;
+    FrameHistory& operator=(const FrameHistory&) = delete;
+
+    // keeps key's images from the num_frames frames before the one reading them, 0 lets go of them
+    void retain(const Key& key, const std::size_t num_frames);
+
+    // the most frames the pipeline runs at once, set before they start
+    void inFlight(const std::size_t num_frames);
+
+    // records key's image from the frame's own context and every camera's. the contexts treat it as shared, so writing to it
+    // afterwards through image() makes a copy rather than changing what's recorded.
+    void record(MultiImageContextInterface& multi_context, const Key& key);
+
+    // the image recorded for frame_id, empty if there isn't one
+    cv::Mat image(const std::size_t index, const Key& key, const std::uint64_t frame_id) const;
+
+    // bytes of the recorded images that no context holds any more, the others are counted by the context
+    std::size_t bytes() const;
+
+  private:
+    struct Entry {
+        std::uint64_t frame_id = std::numeric_limits<std::uint64_t>::max();
+        cv::Mat image;
+    };
+
+    struct Ring {
+        mutable std::mutex mutex;
+        std::size_t num_frames = 0;
+        std::size_t size = 0;
+        std::array<std::vector<Entry>, num_indices> entries;
+    };
+
+    static void resize(Ring& ring, const std::size_t num_frames, const std::size_t in_flight);
+    void record(Ring& ring, const std::size_t index, ImageContextInterface& context, const Key& key, const std::uint64_t frame_id);
+
+    mutable std::mutex mutex_;
+    std::size_t in_flight_ = 1;
+    std::array<std::atomic<Ring*>, Key::max_keys> rings_{};
+    std::vector<const Ring*> retained_;
+};
+}  // namespace hastings
@@ -0,0 +1,151 @@
+#include "hastings/pipeline/frame_pool.h"
+
+#include <cstdint>
+#include <new>
+
+namespace hastings {
+cv::UMatData* FramePool::allocate(const int dims, const int* sizes, const int type, void* data, size_t* step, const cv::AccessFlag flags,
+                                  const cv::UMatUsageFlags usage_flags) const {
+    // NOTE(will): wrapping caller-owned memory, there's nothing to pool.
+    if (data != nullptr) {
+        return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usage_flags);
+    }
+
+    auto total = std::size_t(CV_ELEM_SIZE(type));
+    for (auto idx = dims - 1; idx >= 0; --idx) {
+        if (step != nullptr) {
+            step[idx] = total;
+        }
+        total *= sizes[idx];
+    }
+
+    std::vector<cv::UMatData*> freed;
+    cv::UMatData* reused = nullptr;
+    std::uint64_t serial = 0;
+    {
+        std::lock_guard lock(mutex_);
+        num_allocated_ += 1;
+        if (num_allocated_ % max_idle == 0) {
+            dropIdle(freed);
+        }
+
+        auto& bucket = free_[total];
+        bucket.last_used = num_allocated_;
+        if (!bucket.buffers.empty()) {
+            reused = bucket.buffers.back();
+            bucket.buffers.pop_back();
+            stats_.num_reuses += 1;
+            stats_.bytes_retained -= total;
+        } else {
+            serial = ++stats_.num_allocations;
+        }
+    }
+
+    freeBuffers(freed);
+    if (reused != nullptr) {
+        return reused;
+    }
+
+    auto allocated = new cv::UMatData(this);
+    allocated->data = allocated->origdata = static_cast<uchar*>(cv::fastMalloc(total));
+    allocated->size = total;
+    allocated->userdata = reinterpret_cast<void*>(std::uintptr_t(serial));
+    return allocated;
+}
+
+bool FramePool::allocate(cv::UMatData* data, cv::AccessFlag, cv::UMatUsageFlags) const { return data != nullptr; }
+
+void FramePool::deallocate(cv::UMatData* data) const {
+    if (data == nullptr) {
+        return;
+    }
+
+    // NOTE(will): the header is rebuilt in place so the next image starts from a fresh one without another heap allocation.
+    const auto origdata = data->origdata;
+    const auto size = data->size;
+    const auto userdata = data->userdata;
+    data->~UMatData();
+    new (data) cv::UMatData(this);
+    data->data = data->origdata = origdata;
+    data->size = size;
+    data->userdata = userdata;
+
+    {
+        std::lock_guard lock(mutex_);
+        if (stats_.bytes_retained + size <= max_retained_) {
+            free_[size].buffers.emplace_back(data);
+            stats_.bytes_retained += size;
+            return;
+        }
+        stats_.num_freed += 1;
+    }
+
+    cv::fastFree(origdata);
+    delete data;
+}
+
+void FramePool::maxRetained(const std::size_t bytes) {
+    {
+        std::lock_guard lock(mutex_);
+        max_retained_ = bytes;
+    }
+    trim(bytes);
+}
+
+void FramePool::trim(const std::size_t bytes) {
+    std::vector<cv::UMatData*> freed;
+    {
+        std::lock_guard lock(mutex_);
+        for (auto& [size, bucket] : free_) {
+            while (stats_.bytes_retained > bytes && !bucket.buffers.empty()) {
+                freed.emplace_back(bucket.buffers.back());
+                bucket.buffers.pop_back();
+                stats_.bytes_retained -= size;
+                stats_.num_freed += 1;
+            }
+        }
+    }
+
+    freeBuffers(freed);
+}
+
+void FramePool::dropIdle(std::vector<cv::UMatData*>& freed) const {
+    for (auto iter = free_.begin(); iter != free_.end();) {
+        auto& [size, bucket] = *iter;
+        if (num_allocated_ - bucket.last_used < max_idle) {
+            ++iter;
+            continue;
+        }
+
+        freed.insert(freed.end(), bucket.buffers.begin(), bucket.buffers.end());
+        stats_.bytes_retained -= size * bucket.buffers.size();
+        stats_.num_freed += bucket.buffers.size();
+        iter = free_.erase(iter);
+    }
+}
+
+void FramePool::freeBuffers(const std::vector<cv::UMatData*>& freed) {
+    for (auto data : freed) {
+        cv::fastFree(data->origdata);
+        delete data;
+    }
+}
+
+std::uint64_t FramePool::serial(const cv::UMatData* data) {
+    if (data == nullptr || dynamic_cast<const FramePool*>(data->currAllocator) == nullptr) {
+        return 0;
+    }
+    return std::uint64_t(reinterpret_cast<std::uintptr_t>(data->userdata));
+}
+
+FramePoolStats FramePool::stats() const {
+    std::lock_guard lock(mutex_);
+    return stats_;
+}
+
+FramePool& framePool() {
+    // NOTE(will): leaked on purpose, images handed out by contexts can be released during static destruction.
+    static auto pool = new FramePool();
+    return *pool;
+}
+}  // namespace hastings
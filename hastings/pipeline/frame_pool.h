@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <opencv2/core.hpp>
+#include <vector>
+
+namespace hastings {
+struct FramePoolStats {
+    // buffers taken from the heap, and buffers handed out again from the pool
+    std::uint64_t num_allocations = 0;
+    std::uint64_t num_reuses = 0;
+    // idle buffers freed as they were over the retain limit or their size was no longer asked for
+    std::uint64_t num_freed = 0;
+    std::size_t bytes_retained = 0;
+};
+
+// NOTE(will): a cv::MatAllocator that keeps released buffers, bucketed by size in bytes, and hands them to the next image of the
+// same size. contexts set it on every image, so once each context has made its images a steady-state frame allocates nothing.
+// buffers can outlive the context that made them, so there's a single pool which is never destroyed. idle sizes are swept every
+// max_idle allocations, a size that stops being asked for (after a resolution change, say) is freed within two sweeps.
+class FramePool final : public cv::MatAllocator {
+  public:
+    static constexpr std::size_t default_max_retained = std::size_t(1) << 30;
+    static constexpr std::uint64_t max_idle = 4096;
+
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step, cv::AccessFlag flags,
+                           cv::UMatUsageFlags usage_flags) const override final;
+    bool allocate(cv::UMatData* data, cv::AccessFlag flags, cv::UMatUsageFlags usage_flags) const override final;
+    void deallocate(cv::UMatData* data) const override final;
+
+    // idle buffers past this many bytes are freed instead of kept, default_max_retained until set
+    void maxRetained(std::size_t bytes);
+
+    // frees idle buffers until no more than bytes are kept, the limit stays as it is
+    void trim(std::size_t bytes);
+
+    // which of the pool's heap allocations data was, it's num_allocations at the time. 0 if data isn't from a frame pool
+    static std::uint64_t serial(const cv::UMatData* data);
+
+    FramePoolStats stats() const;
+
+  private:
+    struct Bucket {
+        std::vector<cv::UMatData*> buffers;
+        // the allocation that last asked for this size
+        std::uint64_t last_used = 0;
+    };
+
+    // takes out the buffers of sizes not asked for in the last max_idle allocations for freeing, called with mutex_ held
+    void dropIdle(std::vector<cv::UMatData*>& freed) const;
+    static void freeBuffers(const std::vector<cv::UMatData*>& freed);
+
+    mutable std::mutex mutex_;
+    mutable std::map<std::size_t, Bucket> free_;
+    mutable FramePoolStats stats_;
+    mutable std::uint64_t num_allocated_ = 0;
+    std::size_t max_retained_ = default_max_retained;
+};
+
+FramePool& framePool();
+}  // namespace hastings
@@ -0,0 +1,96 @@
+#include "hastings/pipeline/key.h"
+
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace hastings {
+namespace {
+// NOTE(will): unordered_map nodes don't move on rehash, so the names handed out can point at the map's keys.
+class NameRegistry {
+  public:
+    NameRegistry(const std::size_t max_names, const char* what) : max_names_(max_names), what_(what) {}
+
+    std::tuple<std::size_t, const std::string*> intern(const std::string& name) {
+        const auto interned = tryIntern(name);
+        if (!interned.has_value()) {
+            throw std::length_error(std::string("too many ") + what_);
+        }
+        return interned.value();
+    }
+
+    std::optional<std::tuple<std::size_t, const std::string*>> tryIntern(const std::string& name) {
+        std::lock_guard lock(mutex_);
+        const auto iter = ids_.find(name);
+        if (iter != ids_.end()) {
+            return std::make_tuple(iter->second, &iter->first);
+        }
+
+        if (names_.size() == max_names_) {
+            return std::nullopt;
+        }
+
+        const auto id = names_.size();
+        names_.emplace_back(&ids_.emplace(name, id).first->first);
+        return std::make_tuple(id, names_.back());
+    }
+
+    void bind(const std::size_t id, const std::type_info& type) {
+        std::lock_guard lock(mutex_);
+        const auto [iter, is_new] = types_.emplace(id, type);
+        if (!is_new && iter->second != std::type_index(type)) {
+            throw std::invalid_argument("result key " + *names_[id] + " is already used with another type");
+        }
+    }
+
+  private:
+    const std::size_t max_names_;
+    const char* what_;
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::size_t> ids_;
+    std::vector<const std::string*> names_;
+    std::unordered_map<std::size_t, std::type_index> types_;
+};
+
+NameRegistry& keys() {
+    static NameRegistry registry(Key::max_keys, "context keys");
+    return registry;
+}
+
+NameRegistry& cameras() {
+    static NameRegistry registry(CameraId::max_cameras, "cameras");
+    return registry;
+}
+}  // namespace
+
+Key::Key(const std::string& name) { std::tie(id_, name_) = keys().intern(name); }
+
+Key::Key(const std::string& name, const std::type_info& type) : Key(name) { keys().bind(id_, type); }
+
+Key::Key(const std::size_t id, const std::string* name) : id_(id), name_(name) {}
+
+std::optional<Key> Key::tryIntern(const std::string& name) {
+    const auto interned = keys().tryIntern(name);
+    if (!interned.has_value()) {
+        return std::nullopt;
+    }
+    return Key(std::get<0>(*interned), std::get<1>(*interned));
+}
+
+CameraId::CameraId(const std::string& name) { std::tie(id_, name_) = cameras().intern(name); }
+
+CameraId::CameraId(const std::size_t id, const std::string* name) : id_(id), name_(name) {}
+
+std::optional<CameraId> CameraId::tryIntern(const std::string& name) {
+    const auto interned = cameras().tryIntern(name);
+    if (!interned.has_value()) {
+        return std::nullopt;
+    }
+    return CameraId(std::get<0>(*interned), std::get<1>(*interned));
+}
+}  // namespace hastings
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <typeinfo>
+
+namespace hastings {
+// NOTE(will): an interned context key. resolving a name takes a lock & a hash lookup, so nodes resolve their keys once (in their
+// constructor) and contexts index flat storage by the key's id. ids are shared by every context and never reused.
+class Key {
+  public:
+    static constexpr std::size_t max_keys = 4096;
+
+    explicit Key(const std::string& name);
+
+    // the key for name, or nullopt if name isn't a key yet and all max_keys are taken. the constructor throws std::length_error then
+    static std::optional<Key> tryIntern(const std::string& name);
+
+    std::size_t id() const { return id_; }
+    const std::string& name() const { return *name_; }
+
+    bool operator==(const Key& other) const { return id_ == other.id_; }
+    bool operator!=(const Key& other) const { return id_ != other.id_; }
+
+  private:
+    template <class T>
+    friend class ResultKey;
+
+    // binds the name to a result type, throws std::invalid_argument if it's already bound to another
+    Key(const std::string& name, const std::type_info& type);
+    Key(const std::size_t id, const std::string* name);
+
+    std::size_t id_;
+    const std::string* name_;
+};
+
+// NOTE(will): a key for a typed result, ImageContextInterface::result(key) returns a T& without an any_cast. typed results are
+// stored apart from the std::any results of the same name and are cleared in place, so a vector keeps its capacity between frames.
+template <class T>
+class ResultKey {
+  public:
+    explicit ResultKey(const std::string& name) : key_(name, typeid(T)) {}
+
+    const Key& key() const { return key_; }
+    const std::string& name() const { return key_.name(); }
+
+  private:
+    Key key_;
+};
+
+// NOTE(will): an interned camera name, interned like Key in a registry of its own. register cameras with the pipeline up front,
+// every context then has a slot made for them before the first frame and looks them up by id.
+class CameraId {
+  public:
+    static constexpr std::size_t max_cameras = 64;
+
+    explicit CameraId(const std::string& name);
+
+    // the camera for name, or nullopt if name isn't a camera yet and all max_cameras are taken. the constructor throws
+    // std::length_error then
+    static std::optional<CameraId> tryIntern(const std::string& name);
+
+    std::size_t id() const { return id_; }
+    const std::string& name() const { return *name_; }
+
+    bool operator==(const CameraId& other) const { return id_ == other.id_; }
+    bool operator!=(const CameraId& other) const { return id_ != other.id_; }
+
+  private:
+    CameraId(const std::size_t id, const std::string* name);
+
+    std::size_t id_;
+    const std::string* name_;
+};
+}  // namespace hastings
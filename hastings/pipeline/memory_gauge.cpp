@@ -0,0 +1,34 @@
+#include "hastings/pipeline/memory_gauge.h"
+
+#include "hastings/pipeline/frame_history.h"
+#include "hastings/pipeline/frame_pool.h"
+
+namespace hastings {
+void MemoryGauge::count(std::size_t& frame_bytes, const std::size_t bytes) {
+    bytes_in_use_ += bytes - frame_bytes;
+    frame_bytes = bytes;
+}
+
+void MemoryGauge::sample(const MultiImageContextInterface& multi_context) {
+    if (multi_context.frameId() % sample_interval != 0) {
+        return;
+    }
+
+    auto memory = multi_context.memory();
+
+    std::lock_guard lock(mutex_);
+    memory_.swap(memory);
+}
+
+void MemoryGauge::trimPool() const {
+    const auto held = bytes_in_use_ + history_.bytes();
+    framePool().trim(held < budget_ ? budget_ - held : 0);
+}
+
+std::size_t MemoryGauge::held() const { return bytes_in_use_ + framePool().stats().bytes_retained + history_.bytes(); }
+
+std::vector<KeyMemory> MemoryGauge::memory() const {
+    std::lock_guard lock(mutex_);
+    return memory_;
+}
+}  // namespace hastings
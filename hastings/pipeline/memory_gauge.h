@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+#include "hastings/pipeline/context.h"
+#include "hastings/pipeline/stats.h"
+
+namespace hastings {
+class FrameHistory;
+
+// NOTE(will): what a pipeline's frames hold against its memory budget. each frame's context counts as of when it was last measured,
+// on top come the shared frame pool's idle buffers and the images only the history still holds. a finished frame's per-key
+// breakdown is copied out every sample_interval frame ids, copying every frame's names would cost more than its own bookkeeping.
+class MemoryGauge {
+  public:
+    static constexpr std::uint64_t sample_interval = 64;
+
+    explicit MemoryGauge(const FrameHistory& history) : history_(history) {}
+
+    void budget(const std::size_t bytes) { budget_ = bytes; }
+    bool isBudgeted() const { return budget_ != std::numeric_limits<std::size_t>::max(); }
+    bool isOverBudget() const { return held() > budget_; }
+
+    // counts a frame as holding bytes instead of what it was counted with before, frame_bytes keeps track of that
+    void count(std::size_t& frame_bytes, const std::size_t bytes);
+    void measure(const MultiImageContextInterface& multi_context, std::size_t& frame_bytes) { count(frame_bytes, multi_context.bytes()); }
+
+    // keeps the context's per-key breakdown if its frame id is due a sample
+    void sample(const MultiImageContextInterface& multi_context);
+
+    // a throttled frame's context clears into the frame pool, which is trimmed to what still fits in the budget
+    void trimPool() const;
+
+    std::size_t held() const;
+    std::vector<KeyMemory> memory() const;
+
+  private:
+    const FrameHistory& history_;
+    std::size_t budget_ = std::numeric_limits<std::size_t>::max();
+    std::atomic<std::size_t> bytes_in_use_ = 0;
+
+    mutable std::mutex mutex_;
+    std::vector<KeyMemory> memory_;
+};
+}  // namespace hastings
@@ -1,7 +1,13 @@
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <functional>
+#include <future>
 #include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include "hastings/pipeline/context.h"
 
@@ -11,6 +17,19 @@ enum class ExecutionPolicy {
     Ordered,
     Unordered,
     Parallel,
+    Batched,
+    PerCamera,
+    OrderedPerCamera,
+};
+
+// context keys (image & result names) a node reads and writes for each frame
+struct Dependencies {
+    using Keys = std::vector<std::string>;
+
+    Keys inputs;
+    Keys outputs;
+    // keys read from the previous frame through MultiImageContextInterface::previous(), frame N waits on frame N - 1's writers
+    Keys previous;
 };
 
 class NodeInterface {
@@ -23,7 +42,100 @@ class NodeInterface {
     virtual ExecutionPolicy executionPolicy() const = 0;
     virtual std::string name() const = 0;
 
+    // NOTE(will): nodes without declared dependencies are treated as reading & writing every key, so they run alone within a frame.
+    virtual std::optional<Dependencies> dependencies() const { return std::nullopt; }
+
+    // NOTE(will): warm-up hook (loading engines, allocating buffers...), called once before the node's first frame. the pipeline
+    // initializes all its nodes concurrently.
+    virtual void initialize() {}
+
+    // NOTE(will): runs before the frame waits for its turn, so ordered & unordered nodes can do the work that only depends on the
+    // current frame out of order and concurrently with other frames' process. it mustn't touch state shared across frames.
+    virtual void prepare(MultiImageContextInterface&) {}
+
     // todo(will) - handle fetching & adjusting settings...
     virtual void process(MultiImageContextInterface& multi_context) = 0;
 };
-}  // namespace hastings
\ No newline at end of file
+
+// NOTE(will): nodes that wait on I/O, processAsync starts the work and returns straight away, done is called (from any thread)
+// once the frame is finished so the worker can run other frames in the meantime. the execution policy still applies, an ordered
+// node isn't handed frame N + 1 until frame N is done.
+class AsyncNodeInterface : public NodeInterface {
+  public:
+    using FnDone = std::function<void()>;
+
+    virtual void processAsync(MultiImageContextInterface& multi_context, FnDone&& done) = 0;
+
+    void process(MultiImageContextInterface& multi_context) override {
+        std::promise<void> promise;
+        processAsync(multi_context, [&promise] { promise.set_value(); });
+        promise.get_future().wait();
+    }
+};
+
+// NOTE(will): nodes that amortise their per-call overhead across frames (e.g. inference), the executor gathers up to batchSize
+// in-flight frames, or whatever has arrived after batchTimeout, and calls processBatch once. batches run one at a time.
+class BatchNodeInterface : public NodeInterface {
+  public:
+    using Batch = std::vector<MultiImageContextInterface*>;
+    using Duration = std::chrono::steady_clock::duration;
+
+    ExecutionPolicy executionPolicy() const override { return ExecutionPolicy::Batched; }
+
+    virtual std::size_t batchSize() const = 0;
+    virtual Duration batchTimeout() const = 0;
+
+    // frames in the batch are sorted by frame id
+    virtual void processBatch(const Batch& batch) = 0;
+
+    void process(MultiImageContextInterface& multi_context) override { processBatch({&multi_context}); }
+};
+
+// NOTE(will): parallel nodes whose work is independent per camera, the executor runs each camera of a frame as its own task
+// on the worker pool and joins before the frame moves on.
+class CameraNodeInterface : public NodeInterface {
+  public:
+    ExecutionPolicy executionPolicy() const override { return ExecutionPolicy::PerCamera; }
+
+    virtual void processCamera(const std::string& camera, ImageContextInterface& context) = 0;
+
+    // the executors call this, nodes keeping per-camera state can index it by the camera's id
+    virtual void processCamera(const CameraId& camera, ImageContextInterface& context) { processCamera(camera.name(), context); }
+
+    void process(MultiImageContextInterface& multi_context) override {
+        for (const auto& [name, context, camera] : multi_context.cameras()) {
+            processCamera(camera, *context);
+        }
+    }
+};
+
+// NOTE(will): per-camera nodes carrying state between frames, each camera sees its frames in order and its own State while
+// different cameras run concurrently. states are created on a camera's first frame and live as long as the node.
+template <class State>
+class CameraStateNodeInterface : public CameraNodeInterface {
+  public:
+    ExecutionPolicy executionPolicy() const override { return ExecutionPolicy::OrderedPerCamera; }
+
+    virtual void processCamera(const std::string& camera, ImageContextInterface& context, State& state) = 0;
+
+    void processCamera(const std::string& camera, ImageContextInterface& context) override final {
+        processCamera(CameraId(camera), context);
+    }
+
+    void processCamera(const CameraId& camera, ImageContextInterface& context) override final {
+        processCamera(camera.name(), context, state(camera));
+    }
+
+  private:
+    // NOTE(will): a camera's frames run one at a time, so each entry is only touched by one task at once.
+    State& state(const CameraId& camera) {
+        auto& entry = states_[camera.id()];
+        if (!entry) {
+            entry = std::make_unique<State>();
+        }
+        return *entry;
+    }
+
+    std::array<std::unique_ptr<State>, CameraId::max_cameras> states_;
+};
+}  // namespace hastings
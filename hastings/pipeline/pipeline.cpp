@@ -2,13 +2,25 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <future>
+#include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <tuple>
 #include <vector>
 
 #include "hastings/helpers/profile_marker.h"
 #include "hastings/pipeline/executors.h"
+#include "hastings/pipeline/frame_history.h"
+#include "hastings/pipeline/memory_gauge.h"
+#include "hastings/pipeline/scheduler.h"
 
 namespace hastings {
 class Pipeline final : public PipelineInterface {
@@ -18,66 +30,770 @@ class Pipeline final : public PipelineInterface {
     ~Pipeline() = default;
 
     void add(NodeInterface::Ptr&& node) override final {
-        const auto policy = node->executionPolicy();
-        Executor executor;
-
-        switch (policy) {
-            case ExecutionPolicy::Ordered:
-                executor = std::make_unique<OrderedExecutor>(std::move(node));
-                break;
-            case ExecutionPolicy::Unordered:
-                executor = std::make_unique<UnorderedExecutor>(std::move(node));
-                break;
-            case ExecutionPolicy::Parallel:
-                executor = std::make_unique<ParallelExecutor>(std::move(node));
-                break;
-            default:
-                throw std::invalid_argument("unsupported policy");
-        }
+        auto executor = createExecutor(std::move(node));
 
+        addDependencies(executor->dependencies());
         executors_.emplace_back(std::move(executor));
     };
 
+    void add(const FnFactory& factory, const std::size_t num_replicas) override final {
+        ReplicatedExecutor::Replicas replicas;
+        replicas.reserve(num_replicas);
+        for (auto idx = std::size_t(0); idx < num_replicas; ++idx) {
+            replicas.emplace_back(factory());
+        }
+
+        auto executor = std::make_unique<ReplicatedExecutor>(std::move(replicas));
+
+        addDependencies(executor->dependencies());
+        executors_.emplace_back(std::move(executor));
+    }
+
+    CameraId addCamera(const std::string& name) override final { return cameras_.emplace_back(name); }
+
+    void derive(const std::string& key, const Dependencies::Keys& inputs, const ImageContextInterface::FnDerive& fn) override final {
+        if (!executors_.empty()) {
+            throw std::logic_error("derived keys must be registered before any node is added");
+        }
+
+        derived_inputs_[key] = inputs;
+        derivations_.emplace_back(Key(key), fn);
+    }
+
+    void retain(const std::string& key, const std::size_t num_frames) override final {
+        std::lock_guard lock(initialize_mutex_);
+        const Key retained(key);
+        history_.retain(retained, num_frames);
+
+        retained_.erase(std::remove(retained_.begin(), retained_.end(), retained), retained_.end());
+        if (num_frames != 0) {
+            retained_.emplace_back(retained);
+        }
+        addRecorders();
+    }
+
+    void latencyBudget(const Clock::duration budget, const DropPolicy policy) override final {
+        budget_ = budget;
+        drop_policy_ = policy;
+    }
+
+    void memoryBudget(const std::size_t bytes) override final { gauge_.budget(bytes); }
+
+    PipelineStats stats() const override final {
+        PipelineStats stats;
+        stats.num_frames = num_completed_;
+        stats.num_dropped = num_dropped_;
+        stats.frame = frame_latency_.summary();
+        stats.bytes_in_use = gauge_.held();
+        stats.num_throttled = num_throttled_;
+        stats.memory = gauge_.memory();
+
+        stats.nodes.reserve(executors_.size());
+        for (const auto& executor : executors_) {
+            stats.nodes.emplace_back(executor->stats());
+        }
+        return stats;
+    }
+
+    void initialize() override final {
+        std::lock_guard lock(initialize_mutex_);
+
+        std::vector<ExecutorInterface*> executors;
+        for (auto index = num_initialized_.load(); index < executors_.size(); ++index) {
+            executors.emplace_back(executors_[index].get());
+        }
+
+        initializeExecutors(executors, scheduler());
+        if (!executors.empty()) {
+            addPreviousWriters();
+            addRecorders();
+        }
+
+        if (!requests_) {
+            requests_.reset(new Run{scheduler(), std::numeric_limits<std::uint64_t>::max(), false});
+        }
+
+        // NOTE(will): pooled request frames are sized for the nodes they were created with. ones still in flight can't be dropped,
+        // requestFrame resizes those when they're next taken.
+        if (!executors.empty()) {
+            std::lock_guard requests_lock(requests_mutex_);
+            if (free_requests_.size() == request_frames_.size()) {
+                request_frames_.clear();
+                free_requests_.clear();
+            }
+        }
+
+        num_initialized_ = executors_.size();
+    }
+
     void start(const std::uint64_t num_frames) override final {
         ProfilerConnection profiler;
 
-        std::vector<std::thread> threads;
-        threads.reserve(num_threads_);
+        initialize();
 
-        for (int idx = 0; idx < num_threads_; ++idx) {
-            threads.emplace_back([this, num_frames] {
-                const auto context = createMultiImageContext();
+        // NOTE(will): one frame in flight per thread, each (frame, node) pair runs as its own task so a frame parked on an
+        // ordered node frees its worker to pick up other frames' nodes. previous-frame inputs need at least two frames.
+        const auto num_slots = has_previous_ ? std::max(num_threads_, 2u) : num_threads_;
+        if (frames_.size() != num_slots || frames_num_nodes_ != executors_.size()) {
+            for (const auto& frame : frames_) {
+                gauge_.count(frame->bytes, 0);
+            }
 
-                while (true) {
-                    const auto frame_id = frame_id_++;
-                    if (frame_id >= num_frames) {
-                        return;
-                    }
+            frames_.clear();
+            for (auto idx = 0u; idx < num_slots; ++idx) {
+                auto& frame = *frames_.emplace_back(createFrame());
+                frame.storage = createMultiImageContext();
+                frame.context = frame.storage.get();
+            }
+            frames_num_nodes_ = executors_.size();
+        }
+        history_.inFlight(frames_.size());
 
-                    context->clear();
-                    context->frameId(frame_id);
+        for (auto& frame : frames_) {
+            prepareContext(*frame->context);
+        }
 
-                    ProfilerFunctionMarker marker_frame("frame");
+        const auto first_frame = frame_id_.load();
+        const auto end_frame = num_frames > std::numeric_limits<std::uint64_t>::max() - first_frame
+                                   ? std::numeric_limits<std::uint64_t>::max()
+                                   : first_frame + num_frames;
 
-                    for (auto& executor : executors_) {
-                        executor->process(*context);
-                    }
-                }
-            });
+        Run run{*scheduler_, end_frame};
+        run.num_active = frames_.size();
+
+        for (auto& frame : frames_) {
+            scheduler_->submit([this, &run, frame = frame.get()] { nextFrame(run, *frame); });
         }
 
-        for (auto& thread : threads) {
-            thread.join();
+        {
+            std::unique_lock lock(run.mutex);
+            run.cv.wait(lock, [&run] { return run.num_active == 0; });
         }
+
+        // NOTE(will): cleared once the run is over rather than as it begins, a stop() from before start() ends that run.
+        stopping_ = false;
     };
 
+    void stop() override final { stopping_ = true; }
+
+    std::future<void> submit(MultiImageContextInterface& multi_context) override final {
+        if (num_initialized_ != executors_.size()) {
+            initialize();
+        }
+
+        // NOTE(will): a submitted context has no previous frame to read from, the caller would have to keep one alive for it.
+        if (has_previous_) {
+            throw std::logic_error("previous-frame inputs are only supported for frames from start");
+        }
+
+        prepareContext(multi_context);
+
+        auto& frame = requestFrame();
+        frame.context = &multi_context;
+        frame.request.emplace();
+        auto future = frame.request->get_future();
+
+        const auto frame_id = claimFrameId(*requests_).value();
+        started(frame_id);
+        multi_context.frameId(frame_id);
+        frame.start = Clock::now();
+        frame.dropped = false;
+
+        launchFrame(*requests_, frame, nullptr);
+        return future;
+    }
+
   private:
     using Executor = std::unique_ptr<ExecutorInterface>;
+    using Index = std::size_t;
+
+    struct Frame {
+        // NOTE(will): frames from start own their context, submitted frames point at the caller's and fulfil request when done.
+        MultiImageContextInterface* context = nullptr;
+        MultiImageContextInterface::Ptr storage;
+        std::optional<std::promise<void>> request;
+        Clock::time_point start;
+        std::atomic<bool> dropped = false;
+        std::unique_ptr<std::atomic<std::size_t>[]> num_dependencies;
+        std::atomic<std::size_t> num_remaining = 0;
+
+        // what the context held when last measured, counted in gauge_
+        std::size_t bytes = 0;
+
+        // NOTE(will): only used with previous-frame inputs. a frame is recycled once its nodes are done, its successor has started
+        // and the successor's previous-frame readers have finished, num_holds counts those three.
+        Frame* previous = nullptr;
+        std::atomic<std::size_t> num_holds = 0;
+        std::atomic<std::size_t> num_previous_readers = 0;
+        std::mutex mutex;
+        std::vector<bool> done;
+        std::vector<std::vector<std::tuple<Frame*, Index>>> waiters;
+    };
+
+    struct Run {
+        Run(Scheduler& scheduler, const std::uint64_t end_frame, const bool is_stoppable = true)
+            : scheduler(scheduler), end_frame(end_frame), is_stoppable(is_stoppable) {}
+
+        Scheduler& scheduler;
+        std::uint64_t end_frame;
+        bool is_stoppable;
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::size_t num_active = 0;
+        Frame* last_started = nullptr;
+        bool ended = false;
+
+        // only used with a memory budget, frames that passed the budget check and frames waiting for one of them to finish
+        std::size_t num_running = 0;
+        std::vector<Frame*> throttled;
+    };
+
+    // NOTE(will): builds the per-frame DAG, a node depends on the last writer of each key it reads, and on the last writer &
+    // readers of each key it writes. nodes without declarations act as a barrier between everything before and after them.
+    void addDependencies(std::optional<Dependencies> dependencies) {
+        if (dependencies.has_value()) {
+            dependencies->inputs = withDerivedInputs(dependencies->inputs);
+            dependencies->previous = withDerivedInputs(dependencies->previous);
+        }
+
+        const auto index = executors_.size();
+        dependencies_.emplace_back(dependencies);
+
+        std::set<Index> parents;
+        if (last_barrier_.has_value()) {
+            parents.emplace(last_barrier_.value());
+        }
+
+        if (!dependencies.has_value()) {
+            parents.insert(since_barrier_.begin(), since_barrier_.end());
+
+            last_barrier_ = index;
+            since_barrier_.clear();
+            last_writers_.clear();
+            readers_.clear();
+        } else {
+            for (const auto& key : dependencies->inputs) {
+                const auto iter = last_writers_.find(key);
+                if (iter != last_writers_.end()) {
+                    parents.emplace(iter->second);
+                }
+            }
+
+            for (const auto& key : dependencies->outputs) {
+                const auto iter = last_writers_.find(key);
+                if (iter != last_writers_.end()) {
+                    parents.emplace(iter->second);
+                }
+
+                auto& readers = readers_[key];
+                parents.insert(readers.begin(), readers.end());
+            }
+
+            for (const auto& key : dependencies->inputs) {
+                readers_[key].emplace_back(index);
+            }
+
+            for (const auto& key : dependencies->outputs) {
+                last_writers_[key] = index;
+                readers_[key].clear();
+            }
+
+            since_barrier_.emplace_back(index);
+        }
+
+        parents.erase(index);
+        for (const auto parent : parents) {
+            children_[parent].emplace_back(index);
+        }
+
+        children_.emplace_back();
+        num_parents_.emplace_back(parents.size());
+    }
+
+    // NOTE(will): frame N of a node reading previous-frame keys waits on frame N - 1's writers of those keys (or on any node without
+    // declarations), rather than on the whole of frame N - 1.
+    void addPreviousWriters() {
+        previous_writers_.assign(executors_.size(), {});
+        has_previous_ = false;
+
+        for (auto index = Index(0); index < executors_.size(); ++index) {
+            if (!dependencies_[index].has_value() || dependencies_[index]->previous.empty()) {
+                continue;
+            }
+
+            const auto& keys = dependencies_[index]->previous;
+            for (auto writer = Index(0); writer < executors_.size(); ++writer) {
+                const auto& writes = dependencies_[writer];
+                const auto is_writer = !writes.has_value() || std::any_of(keys.begin(), keys.end(), [&writes](const std::string& key) {
+                    return std::find(writes->outputs.begin(), writes->outputs.end(), key) != writes->outputs.end();
+                });
+
+                if (is_writer) {
+                    previous_writers_[index].emplace_back(writer);
+                }
+            }
+            has_previous_ = true;
+        }
+    }
+
+    void addRecorders() { recorders_ = FrameHistory::recorders(retained_, dependencies_); }
+
+    void nextFrame(Run& run, Frame& frame) {
+        if (gauge_.isBudgeted() && isThrottled(run, frame)) {
+            return;
+        }
+
+        // NOTE(will): reset before the frame is published as last_started, its successor may start registering straight after.
+        if (has_previous_) {
+            std::fill(frame.done.begin(), frame.done.end(), false);
+            frame.num_holds = 2;
+        }
+
+        std::uint64_t frame_id = 0;
+        Frame* previous = nullptr;
+        {
+            std::unique_lock lock(run.mutex, std::defer_lock);
+            if (has_previous_) {
+                lock.lock();
+            }
+
+            const auto claimed = claimFrameId(run);
+            if (!claimed.has_value()) {
+                if (!lock.owns_lock()) {
+                    lock.lock();
+                }
+
+                // NOTE(will): the last frame has no successor to release its hold.
+                if (has_previous_ && !run.ended) {
+                    run.ended = true;
+                    previous = run.last_started;
+                }
+
+                // throttled frames are still active, so run outlives waking them. the frame gives back what it was admitted with
+                std::vector<Frame*> throttled;
+                if (gauge_.isBudgeted()) {
+                    measure(frame);
+                    run.num_running -= 1;
+                    throttled.swap(run.throttled);
+                }
+
+                run.num_active -= 1;
+                run.cv.notify_all();
+                lock.unlock();
+
+                if (previous != nullptr) {
+                    release(run, *previous);
+                }
+                wake(run, throttled);
+                return;
+            }
+
+            frame_id = claimed.value();
+            started(frame_id);
+            if (has_previous_) {
+                previous = run.last_started;
+                run.last_started = &frame;
+            }
+        }
+
+        frame.context->clear();
+        frame.context->frameId(frame_id);
+        frame.start = Clock::now();
+        frame.dropped = false;
+
+        if (executors_.empty()) {
+            finishRunning(run, frame);
+            run.scheduler.submit([this, &run, &frame] { nextFrame(run, frame); });
+            return;
+        }
+
+        launchFrame(run, frame, previous);
+    }
+
+    void launchFrame(Run& run, Frame& frame, Frame* previous) {
+        // NOTE(will): the extra count is held while the roots are submitted, otherwise they could finish the last frame and
+        // return start while this loop is still reading num_parents_.
+        frame.num_remaining = executors_.size() + 1;
+        for (auto index = Index(0); index < executors_.size(); ++index) {
+            frame.num_dependencies[index] = num_parents_[index];
+        }
+
+        if (has_previous_) {
+            startPrevious(run, frame, previous);
+        } else {
+            for (auto index = Index(0); index < executors_.size(); ++index) {
+                if (num_parents_[index] == 0) {
+                    run.scheduler.submit([this, &run, &frame, index] { runNode(run, frame, index); });
+                }
+            }
+        }
+
+        finishFrame(run, frame);
+    }
+
+    // NOTE(will): ids are only taken for frames that will run, ordered executors expect every id and carry on from them next start.
+    // submitted frames draw from the same ids but aren't ended by stop().
+    std::optional<std::uint64_t> claimFrameId(const Run& run) {
+        auto frame_id = frame_id_.load();
+        do {
+            if ((run.is_stoppable && stopping_) || frame_id >= run.end_frame) {
+                return std::nullopt;
+            }
+        } while (!frame_id_.compare_exchange_weak(frame_id, frame_id + 1));
+
+        return frame_id;
+    }
+
+    void started(const std::uint64_t frame_id) {
+        auto latest = latest_started_.load();
+        while (latest < frame_id && !latest_started_.compare_exchange_weak(latest, frame_id)) {
+        }
+    }
+
+    // NOTE(will): a derived key is read through the inputs it's made from, and through theirs if they're derived too.
+    Dependencies::Keys withDerivedInputs(const Dependencies::Keys& keys) const {
+        auto expanded = keys;
+        for (auto index = std::size_t(0); index < expanded.size(); ++index) {
+            const auto iter = derived_inputs_.find(expanded[index]);
+            if (iter == derived_inputs_.end()) {
+                continue;
+            }
+
+            for (const auto& input : iter->second) {
+                if (std::find(expanded.begin(), expanded.end(), input) == expanded.end()) {
+                    expanded.emplace_back(input);
+                }
+            }
+        }
+        return expanded;
+    }
+
+    void prepareContext(MultiImageContextInterface& multi_context) const {
+        for (const auto& camera : cameras_) {
+            multi_context.cameras(camera);
+        }
+
+        if (multi_context.history() == &history_) {
+            return;
+        }
+
+        for (const auto& [key, fn] : derivations_) {
+            multi_context.derive(key, fn);
+        }
+        multi_context.history(&history_);
+    }
+
+    std::unique_ptr<Frame> createFrame() const {
+        auto frame = std::make_unique<Frame>();
+        sizeFrame(*frame);
+        return frame;
+    }
+
+    void sizeFrame(Frame& frame) const {
+        frame.num_dependencies = std::make_unique<std::atomic<std::size_t>[]>(executors_.size());
+        frame.done.resize(executors_.size());
+        frame.waiters.resize(executors_.size());
+    }
+
+    Frame& requestFrame() {
+        std::lock_guard lock(requests_mutex_);
+        if (free_requests_.empty()) {
+            return *request_frames_.emplace_back(createFrame());
+        }
+
+        auto frame = free_requests_.back();
+        free_requests_.pop_back();
+        if (frame->done.size() != executors_.size()) {
+            sizeFrame(*frame);
+        }
+        return *frame;
+    }
+
+    Scheduler& scheduler() {
+        if (!scheduler_) {
+            scheduler_ = std::make_unique<Scheduler>(num_threads_);
+        }
+        return *scheduler_;
+    }
+
+    void startPrevious(Run& run, Frame& frame, Frame* previous) {
+        frame.context->previous(previous != nullptr ? previous->context : nullptr);
+        frame.previous = previous;
+
+        auto num_previous_readers = std::size_t(0);
+        for (const auto& writers : previous_writers_) {
+            num_previous_readers += !writers.empty();
+        }
+        frame.num_previous_readers = num_previous_readers;
+
+        // NOTE(will): readers hold an extra dependency while registering with the previous frame, it could finish their writers
+        // (and decrement) at any point once registered.
+        for (auto index = Index(0); index < executors_.size(); ++index) {
+            if (previous_writers_[index].empty()) {
+                continue;
+            }
+
+            frame.num_dependencies[index] += 1;
+            if (previous == nullptr) {
+                continue;
+            }
+
+            std::lock_guard lock(previous->mutex);
+            for (const auto writer : previous_writers_[index]) {
+                if (!previous->done[writer]) {
+                    frame.num_dependencies[index] += 1;
+                    previous->waiters[writer].emplace_back(&frame, index);
+                }
+            }
+        }
+
+        if (previous != nullptr) {
+            // pin the previous frame for this frame's readers, then drop the hold it kept until its successor started
+            previous->num_holds += 1;
+            release(run, *previous);
+        }
+
+        for (auto index = Index(0); index < executors_.size(); ++index) {
+            const auto is_ready = previous_writers_[index].empty() ? num_parents_[index] == 0 : --frame.num_dependencies[index] == 0;
+            if (is_ready) {
+                run.scheduler.submit([this, &run, &frame, index] { runNode(run, frame, index); });
+            }
+        }
+    }
+
+    void release(Run& run, Frame& frame) {
+        if (--frame.num_holds == 0) {
+            run.scheduler.submit([this, &run, &frame] { nextFrame(run, frame); });
+        }
+    }
+
+    void runNode(Run& run, Frame& frame, const Index index) {
+        if (isDropped(frame)) {
+            executors_[index]->skip(*frame.context);
+            finishNode(run, frame, index);
+            return;
+        }
+
+        // NOTE(will): a frame parked on an ordered, async or replicated node checks the budget again once it's resumed.
+        executors_[index]->schedule(
+            *frame.context, run.scheduler, [this, &run, &frame, index] { finishNode(run, frame, index); },
+            [this, &frame] { return isDropped(frame); });
+    }
+
+    void finishNode(Run& run, Frame& frame, const Index index) {
+        if (!frame.dropped) {
+            for (const auto& key : recorders_.nodes[index]) {
+                history_.record(*frame.context, key);
+            }
+        }
+
+        if (has_previous_) {
+            finishPrevious(run, frame, index);
+        }
+
+        for (const auto child : children_[index]) {
+            if (--frame.num_dependencies[child] == 0) {
+                run.scheduler.submit([this, &run, &frame, child] { runNode(run, frame, child); });
+            }
+        }
+
+        finishFrame(run, frame);
+    }
+
+    void finishFrame(Run& run, Frame& frame) {
+        if (--frame.num_remaining != 0) {
+            return;
+        }
+
+        if (frame.dropped) {
+            num_dropped_ += 1;
+        } else {
+            for (const auto& key : recorders_.frame) {
+                history_.record(*frame.context, key);
+            }
+
+            num_completed_ += 1;
+            frame_latency_.record(Clock::now() - frame.start);
+        }
+
+        if (frame.request.has_value()) {
+            auto request = std::move(frame.request.value());
+            frame.request.reset();
+            {
+                std::lock_guard lock(requests_mutex_);
+                free_requests_.emplace_back(&frame);
+            }
+            request.set_value();
+            return;
+        }
+
+        finishRunning(run, frame);
+        if (has_previous_) {
+            release(run, frame);
+        } else {
+            run.scheduler.submit([this, &run, &frame] { nextFrame(run, frame); });
+        }
+    }
+
+    // NOTE(will): a frame over the budget clears its context so it stops counting against it, then waits for a running frame to
+    // finish. the check is repeated after clearing, a frame that finished meanwhile had nothing to wake. an admitted frame is
+    // counted as holding at least what the last finished frame did, until it's measured itself.
+    bool isThrottled(Run& run, Frame& frame) {
+        const auto is_admitted = [this, &run, &frame] {
+            if (run.num_running != 0 && gauge_.isOverBudget()) {
+                return false;
+            }
+
+            gauge_.count(frame.bytes, std::max(frame.bytes, last_frame_bytes_.load()));
+
+            run.num_running += 1;
+            return true;
+        };
+
+        {
+            std::lock_guard lock(run.mutex);
+            if (is_admitted()) {
+                return false;
+            }
+        }
+
+        frame.context->clear();
+        measure(frame);
+        gauge_.trimPool();
+
+        std::lock_guard lock(run.mutex);
+        if (is_admitted()) {
+            return false;
+        }
+
+        run.throttled.emplace_back(&frame);
+        num_throttled_ += 1;
+        return true;
+    }
+
+    void finishRunning(Run& run, Frame& frame) {
+        measure(frame);
+        gauge_.sample(*frame.context);
+        last_frame_bytes_ = frame.bytes;
+        if (!gauge_.isBudgeted()) {
+            return;
+        }
+
+        std::vector<Frame*> throttled;
+        {
+            std::lock_guard lock(run.mutex);
+            run.num_running -= 1;
+            throttled.swap(run.throttled);
+        }
+        wake(run, throttled);
+    }
+
+    void wake(Run& run, const std::vector<Frame*>& throttled) {
+        for (const auto frame : throttled) {
+            run.scheduler.submit([this, &run, frame] { nextFrame(run, *frame); });
+        }
+    }
+
+    void measure(Frame& frame) { gauge_.measure(*frame.context, frame.bytes); }
+
+    void finishPrevious(Run& run, Frame& frame, const Index index) {
+        std::vector<std::tuple<Frame*, Index>> waiters;
+        {
+            std::lock_guard lock(frame.mutex);
+            frame.done[index] = true;
+            waiters.swap(frame.waiters[index]);
+        }
+
+        for (const auto& [waiter, child] : waiters) {
+            if (--waiter->num_dependencies[child] == 0) {
+                run.scheduler.submit([this, &run, waiter = waiter, child = child] { runNode(run, *waiter, child); });
+            }
+        }
+
+        if (!previous_writers_[index].empty() && --frame.num_previous_readers == 0 && frame.previous != nullptr) {
+            release(run, *frame.previous);
+        }
+    }
+
+    // NOTE(will): dropped frames still walk the DAG so ordered executors see every frame id, they just skip the nodes.
+    bool isDropped(Frame& frame) {
+        if (frame.dropped) {
+            return true;
+        }
+
+        const auto frame_id = frame.context->frameId();
+        auto is_dropped = frame_id < skip_before_;
+
+        if (!is_dropped && drop_policy_ != DropPolicy::Never && Clock::now() - frame.start > budget_) {
+            is_dropped = true;
+
+            if (drop_policy_ == DropPolicy::SkipToLatest) {
+                const auto latest = latest_started_.load();
+
+                auto skip_before = skip_before_.load();
+                while (skip_before < latest && !skip_before_.compare_exchange_weak(skip_before, latest)) {
+                }
+            }
+        }
+
+        if (is_dropped) {
+            frame.dropped = true;
+        }
+        return is_dropped;
+    }
 
     unsigned int num_threads_;
     std::vector<Executor> executors_;
+    std::vector<CameraId> cameras_;
+    std::vector<std::tuple<Key, ImageContextInterface::FnDerive>> derivations_;
+    std::map<std::string, Dependencies::Keys> derived_inputs_;
+    FrameHistory history_;
+    MemoryGauge gauge_{history_};
+    std::vector<Key> retained_;
+    FrameHistory::Recorders recorders_;
+    std::mutex initialize_mutex_;
+    std::atomic<std::size_t> num_initialized_ = 0;
     std::atomic<std::uint64_t> frame_id_ = 0;
+    std::atomic<bool> stopping_ = false;
+
+    // NOTE(will): frames_ holds the contexts that carry over between runs.
+    std::vector<std::unique_ptr<Frame>> frames_;
+    std::size_t frames_num_nodes_ = 0;
+
+    Clock::duration budget_ = Clock::duration::max();
+    DropPolicy drop_policy_ = DropPolicy::Never;
+    std::atomic<std::uint64_t> skip_before_ = 0;
+    std::atomic<std::uint64_t> latest_started_ = 0;
+
+    std::atomic<std::size_t> last_frame_bytes_ = 0;
+    std::atomic<std::uint64_t> num_throttled_ = 0;
+
+    std::atomic<std::uint64_t> num_completed_ = 0;
+    std::atomic<std::uint64_t> num_dropped_ = 0;
+    LatencyHistogram frame_latency_;
+
+    std::vector<std::vector<Index>> children_;
+    std::vector<std::size_t> num_parents_;
+
+    std::vector<std::optional<Dependencies>> dependencies_;
+    std::vector<std::vector<Index>> previous_writers_;
+    bool has_previous_ = false;
+
+    std::optional<Index> last_barrier_;
+    std::vector<Index> since_barrier_;
+    std::map<std::string, Index> last_writers_;
+    std::map<std::string, std::vector<Index>> readers_;
+
+    // frames for submitted contexts, reused once their request is fulfilled
+    std::unique_ptr<Run> requests_;
+    std::mutex requests_mutex_;
+    std::vector<std::unique_ptr<Frame>> request_frames_;
+    std::vector<Frame*> free_requests_;
+
+    // NOTE(will): the workers live as long as the pipeline, declared last so they're joined before anything they touch is destroyed.
+    std::unique_ptr<Scheduler> scheduler_;
 };
 
 std::unique_ptr<PipelineInterface> createPipeline(const unsigned int num_threads) { return std::make_unique<Pipeline>(num_threads); }
-}  // namespace hastings
\ No newline at end of file
+}  // namespace hastings
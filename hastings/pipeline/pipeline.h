@@ -1,15 +1,31 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
+#include <functional>
+#include <future>
 #include <limits>
 #include <memory>
 #include <thread>
 
 #include "hastings/pipeline/node.h"
+#include "hastings/pipeline/stats.h"
 
 namespace hastings {
+
+enum class DropPolicy {
+    Never,
+    // frames older than the latency budget are abandoned at their next node
+    DropOldest,
+    // once a frame is over budget, every frame older than the latest started frame is abandoned
+    SkipToLatest,
+};
+
 class PipelineInterface {
   public:
+    using Clock = std::chrono::steady_clock;
+    using FnFactory = std::function<NodeInterface::Ptr()>;
+
     PipelineInterface() = default;
     virtual ~PipelineInterface() = default;
 
@@ -20,8 +36,59 @@ class PipelineInterface {
         add(std::make_unique<T>(std::forward<Args>(args)...));
     }
 
+    // NOTE(will): builds num_replicas copies of a thread-unsafe unordered node, each frame borrows whichever replica is free.
+    virtual void add(const FnFactory& factory, const std::size_t num_replicas) = 0;
+
+    template <class T, class... Args>
+    void addReplicated(const std::size_t num_replicas, const Args&... args) {
+        add([&args...] { return std::make_unique<T>(args...); }, num_replicas);
+    }
+
+    // NOTE(will): cameras registered here have their contexts made in every frame before the first one runs, cameras made lazily
+    // mid-frame aren't safe alongside per-camera nodes.
+    virtual CameraId addCamera(const std::string& name) = 0;
+
+    // NOTE(will): fn makes key's image in every context of every frame on its first access, see ImageContextInterface::derive.
+    // nodes reading key wait on the writers of inputs instead of on a writer of key, so it's registered before any node is added,
+    // it throws std::logic_error after.
+    virtual void derive(const std::string& key, const Dependencies::Keys& inputs, const ImageContextInterface::FnDerive& fn) = 0;
+
+    // NOTE(will): keeps key's images from the num_frames frames before each one for nodes to read through
+    // ImageContextInterface::history, recorded as each frame's last writer of key finishes (see FrameHistory::Recorders), so a
+    // reader only sees the frames before its own when it's ordered. 0 lets go of them, call it before start.
+    virtual void retain(const std::string& key, const std::size_t num_frames) = 0;
+
+    virtual void latencyBudget(const Clock::duration budget, const DropPolicy policy = DropPolicy::DropOldest) = 0;
+
+    // NOTE(will): once the contexts of frames from start hold more than bytes, a new frame waits for a running one to finish
+    // instead of adding to the peak, there's always at least one frame running. submitted contexts aren't counted. the frame pool
+    // is shared by every pipeline, its idle buffers count too and it's trimmed to what fits while frames are throttled.
+    virtual void memoryBudget(const std::size_t bytes) = 0;
+
+    // initializes every node not yet initialized, concurrently, start calls it before the first frame if it hasn't been called
+    virtual void initialize() = 0;
+
+    // NOTE(will): blocks until num_frames more frames have run or stop is called. worker threads, contexts and node state are kept
+    // between calls, so a stopped pipeline can be started again; frame ids carry on from the previous run.
     virtual void start(const std::uint64_t num_frames = std::numeric_limits<std::uint64_t>::max()) = 0;
+
+    // asks a running start to finish, frames already in flight complete but no new ones are started. a stop before start
+    // ends the next start without starting any frames
+    virtual void stop() = 0;
+
+    // NOTE(will): runs a caller-owned context through the nodes without a start, taking the next frame id. safe to call from
+    // several threads and alongside a running start, the context isn't cleared and must outlive the returned future.
+    virtual std::future<void> submit(MultiImageContextInterface& multi_context) = 0;
+
+    // blocks until the context has been through every node
+    void process(MultiImageContextInterface& multi_context) { submit(multi_context).get(); }
+
+    // snapshot of frame & per-node latencies, safe to call while the pipeline is running
+    virtual PipelineStats stats() const = 0;
 };
 
 std::unique_ptr<PipelineInterface> createPipeline(const unsigned int num_threads = std::thread::hardware_concurrency());
-}  // namespace hastings
\ No newline at end of file
+
+// NOTE(will): pipelined mode, each ordered & unordered node runs on its own thread and parallel nodes share num_threads workers.
+std::unique_ptr<PipelineInterface> createStagedPipeline(const unsigned int num_threads = std::thread::hardware_concurrency());
+}  // namespace hastings
@@ -0,0 +1,111 @@
+#include "hastings/pipeline/scheduler.h"
+
+#include <stdexcept>
+
+namespace hastings {
+namespace {
+struct CurrentWorker {
+    const Scheduler* scheduler = nullptr;
+    std::size_t index = 0;
+};
+
+thread_local CurrentWorker current_worker;
+}  // namespace
+
+Scheduler::Scheduler(const unsigned int num_threads) {
+    if (num_threads == 0) {
+        throw std::invalid_argument("requires at least one thread");
+    }
+
+    workers_.reserve(num_threads);
+    for (auto idx = 0u; idx < num_threads; ++idx) {
+        workers_.emplace_back(std::make_unique<Worker>());
+    }
+
+    threads_.reserve(num_threads);
+    for (auto idx = 0u; idx < num_threads; ++idx) {
+        threads_.emplace_back([this, idx] { run(idx); });
+    }
+}
+
+Scheduler::~Scheduler() {
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+unsigned int Scheduler::numThreads() const { return workers_.size(); }
+
+void Scheduler::submit(Task&& task) {
+    const auto index = current_worker.scheduler == this ? current_worker.index : next_worker_++ % workers_.size();
+
+    {
+        auto& worker = *workers_[index];
+        std::lock_guard lock(worker.mutex);
+        worker.tasks.emplace_back(std::move(task));
+        num_queued_ += 1;
+    }
+
+    if (num_sleeping_ > 0) {
+        std::lock_guard lock(mutex_);
+        cv_.notify_one();
+    }
+}
+
+bool Scheduler::pop(const std::size_t index, Task& task) {
+    auto& worker = *workers_[index];
+    std::lock_guard lock(worker.mutex);
+    if (worker.tasks.empty()) {
+        return false;
+    }
+
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    num_queued_ -= 1;
+    return true;
+}
+
+bool Scheduler::steal(const std::size_t index, Task& task) {
+    for (auto offset = 1u; offset < workers_.size(); ++offset) {
+        auto& victim = *workers_[(index + offset) % workers_.size()];
+        std::lock_guard lock(victim.mutex);
+        if (victim.tasks.empty()) {
+            continue;
+        }
+
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        num_queued_ -= 1;
+        return true;
+    }
+
+    return false;
+}
+
+void Scheduler::run(const std::size_t index) {
+    current_worker = CurrentWorker{this, index};
+
+    while (true) {
+        Task task;
+        if (pop(index, task) || steal(index, task)) {
+            task();
+            continue;
+        }
+
+        std::unique_lock lock(mutex_);
+        num_sleeping_ += 1;
+        cv_.wait(lock, [this] { return stop_ || num_queued_ > 0; });
+        num_sleeping_ -= 1;
+
+        if (stop_ && num_queued_ == 0) {
+            return;
+        }
+    }
+}
+}  // namespace hastings
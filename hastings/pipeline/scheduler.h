@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hastings {
+// NOTE(will): work-stealing pool, each worker pushes & pops its own deque from the back and steals from the front of the others.
+class Scheduler final {
+  public:
+    using Task = std::function<void()>;
+
+    explicit Scheduler(const unsigned int num_threads);
+    ~Scheduler();
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    unsigned int numThreads() const;
+
+    // tasks submitted from a worker go onto that worker's deque, otherwise they're spread round-robin
+    void submit(Task&& task);
+
+  private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool pop(const std::size_t index, Task& task);
+    bool steal(const std::size_t index, Task& task);
+    void run(const std::size_t index);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::atomic<std::size_t> num_queued_ = 0;
+    std::atomic<std::size_t> num_sleeping_ = 0;
+    std::atomic<std::size_t> next_worker_ = 0;
+    bool stop_ = false;
+};
+}  // namespace hastings
@@ -0,0 +1,103 @@
+#include "hastings/pipeline/sequencer.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace hastings {
+namespace {
+constexpr auto num_spins = 256;
+}
+
+Sequencer::Sequencer(const std::size_t num_slots) : num_slots_(num_slots), slots_(std::make_unique<Slot[]>(num_slots)) {
+    if (num_slots == 0) {
+        throw std::invalid_argument("requires at least one slot");
+    }
+}
+
+Sequencer::Ticket Sequencer::current() const { return current_; }
+
+void Sequencer::wait(const Ticket ticket) {
+    for (auto idx = 0; idx < num_spins; ++idx) {
+        if (current_.load(std::memory_order_acquire) == ticket) {
+            return;
+        }
+        std::this_thread::yield();
+    }
+
+    auto& slot = this->slot(ticket);
+    std::unique_lock lock(slot.mutex);
+    slot.num_waiting += 1;
+    slot.cv.wait(lock, [this, ticket] { return current_ == ticket; });
+    slot.num_waiting -= 1;
+}
+
+bool Sequencer::park(const Ticket ticket, Task&& task) {
+    auto& slot = this->slot(ticket);
+    std::lock_guard lock(slot.mutex);
+
+    slot.num_waiting += 1;
+    if (current_ == ticket) {
+        slot.num_waiting -= 1;
+        return true;
+    }
+
+    slot.parked.emplace_back(ticket, std::move(task));
+    return false;
+}
+
+Sequencer::Task Sequencer::advance() {
+    while (true) {
+        const auto next = ++current_;
+
+        // NOTE(will): current_ is published before num_waiting is read, and waiters register before re-checking current_, so
+        // either the waiter sees the new ticket or we see the waiter.
+        auto& slot = this->slot(next);
+        if (slot.num_waiting == 0) {
+            return {};
+        }
+
+        Task task;
+        {
+            std::lock_guard lock(slot.mutex);
+
+            const auto skipped = std::find(slot.skipped.begin(), slot.skipped.end(), next);
+            if (skipped != slot.skipped.end()) {
+                slot.skipped.erase(skipped);
+                slot.num_waiting -= 1;
+                continue;
+            }
+
+            for (auto iter = slot.parked.begin(); iter != slot.parked.end(); ++iter) {
+                if (std::get<0>(*iter) == next) {
+                    task = std::move(std::get<1>(*iter));
+                    slot.parked.erase(iter);
+                    slot.num_waiting -= 1;
+                    break;
+                }
+            }
+        }
+        slot.cv.notify_all();
+
+        return task;
+    }
+}
+
+Sequencer::Task Sequencer::skip(const Ticket ticket) {
+    {
+        auto& slot = this->slot(ticket);
+        std::lock_guard lock(slot.mutex);
+
+        slot.num_waiting += 1;
+        if (current_ != ticket) {
+            slot.skipped.emplace_back(ticket);
+            return {};
+        }
+        slot.num_waiting -= 1;
+    }
+
+    return advance();
+}
+
+Sequencer::Slot& Sequencer::slot(const Ticket ticket) { return slots_[ticket % num_slots_]; }
+}  // namespace hastings
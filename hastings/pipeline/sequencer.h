@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace hastings {
+// NOTE(will): ticket sequencer for ordered nodes, tickets are handed over through an atomic counter and each ticket waits on its
+// own slot, so completing a ticket only wakes the thread (or parked task) holding the next one.
+class Sequencer final {
+  public:
+    using Ticket = std::size_t;
+    using Task = std::function<void()>;
+
+    explicit Sequencer(const std::size_t num_slots = 64);
+
+    Ticket current() const;
+
+    // spins briefly, then sleeps on the ticket's slot until it's the current ticket
+    void wait(const Ticket ticket);
+
+    // returns true if ticket is already current and leaves task untouched, otherwise keeps hold of task until the ticket is current
+    bool park(const Ticket ticket, Task&& task);
+
+    // completes the current ticket, returns the task parked on the next ticket if there is one
+    Task advance();
+
+    // marks ticket as completed without waiting for its turn, returns the task parked on the next ticket if skipping reached it
+    Task skip(const Ticket ticket);
+
+  private:
+    struct Slot {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::atomic<std::size_t> num_waiting = 0;
+        std::vector<std::tuple<Ticket, Task>> parked;
+        std::vector<Ticket> skipped;
+    };
+
+    Slot& slot(const Ticket ticket);
+
+    std::atomic<Ticket> current_ = 0;
+    std::size_t num_slots_;
+    std::unique_ptr<Slot[]> slots_;
+};
+}  // namespace hastings
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+namespace hastings {
+namespace detail {
+inline std::size_t nextPowerOfTwo(const std::size_t value) {
+    std::size_t capacity = 1;
+    while (capacity < value) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+}  // namespace detail
+
+// NOTE(will): bounded lock-free queue for exactly one producer thread and one consumer thread.
+template <class T>
+class SpscRing {
+  public:
+    explicit SpscRing(const std::size_t capacity)
+        : mask_(detail::nextPowerOfTwo(capacity) - 1), slots_(std::make_unique<T[]>(mask_ + 1)) {
+        if (capacity == 0) {
+            throw std::invalid_argument("requires a non-zero capacity");
+        }
+    }
+
+    std::size_t capacity() const { return mask_ + 1; }
+
+    // returns false without taking value if the ring is full
+    bool push(T&& value) {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) > mask_) {
+            return false;
+        }
+
+        slots_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& value) {
+        const auto head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        value = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+  private:
+    alignas(64) std::atomic<std::size_t> head_ = 0;
+    alignas(64) std::atomic<std::size_t> tail_ = 0;
+    std::size_t mask_;
+    std::unique_ptr<T[]> slots_;
+};
+
+// NOTE(will): single consumer ring keyed by sequence number, any number of producers may put as long as each sequence number is
+// put once and producers never run more than capacity ahead of the consumer. the consumer takes items in sequence order.
+template <class T>
+class ReorderRing {
+  public:
+    explicit ReorderRing(const std::size_t capacity)
+        : mask_(detail::nextPowerOfTwo(capacity) - 1), slots_(std::make_unique<std::atomic<T*>[]>(mask_ + 1)) {
+        if (capacity == 0) {
+            throw std::invalid_argument("requires a non-zero capacity");
+        }
+    }
+
+    std::size_t capacity() const { return mask_ + 1; }
+
+    void put(const std::uint64_t sequence, T* value) { slots_[sequence & mask_].store(value, std::memory_order_release); }
+
+    // returns nullptr if sequence hasn't been put yet
+    T* take(const std::uint64_t sequence) { return slots_[sequence & mask_].exchange(nullptr, std::memory_order_acquire); }
+
+  private:
+    std::size_t mask_;
+    std::unique_ptr<std::atomic<T*>[]> slots_;
+};
+}  // namespace hastings
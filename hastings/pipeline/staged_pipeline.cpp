@@ -0,0 +1,466 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "hastings/helpers/profile_marker.h"
+#include "hastings/pipeline/executors.h"
+#include "hastings/pipeline/frame_history.h"
+#include "hastings/pipeline/memory_gauge.h"
+#include "hastings/pipeline/pipeline.h"
+#include "hastings/pipeline/scheduler.h"
+#include "hastings/pipeline/spsc_ring.h"
+
+namespace hastings {
+namespace {
+// NOTE(will): stage threads poll their inbox, spinning first, then yielding, then sleeping so an idle stage doesn't burn a core.
+class Backoff {
+  public:
+    void pause() {
+        if (count_ < 64) {
+            count_ += 1;
+        } else if (count_ < 128) {
+            count_ += 1;
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    void reset() { count_ = 0; }
+
+  private:
+    int count_ = 0;
+};
+}  // namespace
+
+// NOTE(will): every ordered & unordered node gets a dedicated thread so its state stays hot in one core's cache, contexts flow
+// between those threads over SPSC rings. runs of parallel nodes between them are serviced by a pool and handed back in frame
+// order through a reorder ring. nodes run in the order they were added, declared dependencies are ignored.
+class StagedPipeline final : public PipelineInterface {
+  public:
+    explicit StagedPipeline(const unsigned int num_threads) : num_threads_(num_threads) {}
+
+    void add(NodeInterface::Ptr&& node) override final {
+        // NOTE(will): a stage thread hands over one frame at a time, so a batch would only ever fill by timing out.
+        if (node->executionPolicy() == ExecutionPolicy::Batched) {
+            throw std::invalid_argument("batched nodes are not supported by the staged pipeline");
+        }
+
+        const auto dependencies = node->dependencies();
+        if (dependencies.has_value() && !dependencies->previous.empty()) {
+            throw std::invalid_argument("previous-frame inputs are not supported by the staged pipeline");
+        }
+
+        policies_.emplace_back(node->executionPolicy());
+        executors_.emplace_back(createExecutor(std::move(node)));
+    }
+
+    // NOTE(will): replicas make the node safe to call concurrently, so it runs with the parallel nodes on the pool.
+    void add(const FnFactory& factory, const std::size_t num_replicas) override final {
+        ReplicatedExecutor::Replicas replicas;
+        replicas.reserve(num_replicas);
+        for (auto idx = std::size_t(0); idx < num_replicas; ++idx) {
+            replicas.emplace_back(factory());
+        }
+
+        policies_.emplace_back(ExecutionPolicy::Parallel);
+        executors_.emplace_back(std::make_unique<ReplicatedExecutor>(std::move(replicas)));
+    }
+
+    CameraId addCamera(const std::string& name) override final { return cameras_.emplace_back(name); }
+
+    // NOTE(will): nodes run in the order they were added, so the inputs only matter to the dag pipeline.
+    void derive(const std::string& key, const Dependencies::Keys&, const ImageContextInterface::FnDerive& fn) override final {
+        if (!executors_.empty()) {
+            throw std::logic_error("derived keys must be registered before any node is added");
+        }
+
+        derivations_.emplace_back(Key(key), fn);
+    }
+
+    void retain(const std::string& key, const std::size_t num_frames) override final {
+        std::lock_guard lock(initialize_mutex_);
+        const Key retained(key);
+        history_.retain(retained, num_frames);
+
+        retained_.erase(std::remove(retained_.begin(), retained_.end(), retained), retained_.end());
+        if (num_frames != 0) {
+            retained_.emplace_back(retained);
+        }
+        addRecorders();
+    }
+
+    void latencyBudget(const Clock::duration, const DropPolicy) override final {
+        throw std::logic_error("latency budgets are not supported by the staged pipeline");
+    }
+
+    void memoryBudget(const std::size_t bytes) override final { gauge_.budget(bytes); }
+
+    PipelineStats stats() const override final {
+        PipelineStats stats;
+        stats.num_frames = num_completed_;
+        stats.frame = frame_latency_.summary();
+        stats.bytes_in_use = gauge_.held();
+        stats.num_throttled = num_throttled_;
+        stats.memory = gauge_.memory();
+
+        stats.nodes.reserve(executors_.size());
+        for (const auto& executor : executors_) {
+            stats.nodes.emplace_back(executor->stats());
+        }
+        return stats;
+    }
+
+    void initialize() override final {
+        std::lock_guard lock(initialize_mutex_);
+
+        std::vector<ExecutorInterface*> executors;
+        for (auto index = num_initialized_.load(); index < executors_.size(); ++index) {
+            executors.emplace_back(executors_[index].get());
+        }
+
+        initializeExecutors(executors, pool());
+        if (!executors.empty()) {
+            addRecorders();
+        }
+        num_initialized_ = executors_.size();
+    }
+
+    // NOTE(will): the pool and contexts carry over between runs, stage threads are started per run as the stages may change.
+    void start(const std::uint64_t num_frames) override final {
+        ProfilerConnection profiler;
+
+        initialize();
+
+        const auto first_frame = frame_id_.load();
+        const auto end_frame = num_frames > std::numeric_limits<std::uint64_t>::max() - first_frame
+                                   ? std::numeric_limits<std::uint64_t>::max()
+                                   : first_frame + num_frames;
+
+        Run run{*pool_};
+        buildStages(run);
+
+        for (auto& frame : frames_) {
+            prepareContext(*frame->context);
+        }
+
+        // NOTE(will): enough contexts to keep every stage busy, plus one slot for the end of stream marker.
+        const auto num_contexts = num_threads_ + run.stages.size();
+        history_.inFlight(num_contexts);
+        for (auto& stage : run.stages) {
+            stage.inbox = Inbox(num_contexts + 1, stage.single_producer);
+        }
+        run.completed = Inbox(num_contexts + 1, run.stages.empty() || run.stages.back().serial);
+
+        std::vector<std::thread> threads;
+        for (auto index = std::size_t(0); index < run.stages.size(); ++index) {
+            if (run.stages[index].serial) {
+                threads.emplace_back([this, &run, index] { runSerial(run, index); });
+            }
+        }
+
+        std::uint64_t sequence = 0;
+        std::uint64_t num_completed = 0;
+        std::size_t num_used = 0;
+        Backoff backoff;
+
+        // NOTE(will): over the memory budget, a frame that has completed is reused rather than bringing in another context.
+        while (frame_id_ < end_frame && !stopping_) {
+            Frame* frame = nullptr;
+            const auto is_over_budget = gauge_.isBudgeted() && num_completed != sequence && gauge_.isOverBudget();
+            if (num_used < num_contexts && !is_over_budget) {
+                if (num_used == frames_.size()) {
+                    auto& created = *frames_.emplace_back(std::make_unique<Frame>());
+                    created.context = createMultiImageContext();
+                    prepareContext(*created.context);
+                }
+                frame = frames_[num_used++].get();
+            } else {
+                if (num_used < num_contexts) {
+                    num_throttled_ += 1;
+                }
+
+                while ((frame = run.completed.pop(num_completed)) == nullptr) {
+                    backoff.pause();
+                }
+                backoff.reset();
+                complete(*frame);
+                measure(*frame);
+                gauge_.sample(*frame->context);
+                num_completed += 1;
+            }
+
+            frame->sequence = sequence++;
+            frame->context->clear();
+            if (is_over_budget) {
+                measure(*frame);
+                gauge_.trimPool();
+            }
+            frame->context->frameId(frame_id_++);
+            frame->start = Clock::now();
+            emit(run, 0, frame);
+        }
+
+        Frame end;
+        end.sequence = sequence;
+        end.end = true;
+        emit(run, 0, &end);
+
+        while (num_completed <= sequence) {
+            Frame* frame = nullptr;
+            while ((frame = run.completed.pop(num_completed)) == nullptr) {
+                backoff.pause();
+            }
+            backoff.reset();
+
+            if (!frame->end) {
+                complete(*frame);
+                measure(*frame);
+                gauge_.sample(*frame->context);
+            }
+            num_completed += 1;
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        stopping_ = false;
+    }
+
+    void stop() override final { stopping_ = true; }
+
+    // NOTE(will): stage threads only live for a run, so a submitted context goes through the nodes on the calling thread.
+    std::future<void> submit(MultiImageContextInterface& multi_context) override final {
+        if (num_initialized_ != executors_.size()) {
+            initialize();
+        }
+
+        prepareContext(multi_context);
+
+        Frame frame;
+        frame.start = Clock::now();
+        multi_context.frameId(frame_id_++);
+
+        for (auto index = std::size_t(0); index < executors_.size(); ++index) {
+            executors_[index]->process(multi_context);
+            record(multi_context, recorders_.nodes[index]);
+        }
+        record(multi_context, recorders_.frame);
+        complete(frame);
+
+        std::promise<void> request;
+        request.set_value();
+        return request.get_future();
+    }
+
+  private:
+    struct Frame {
+        MultiImageContextInterface::Ptr context;
+        std::uint64_t sequence = 0;
+        Clock::time_point start;
+        bool end = false;
+
+        // what the context held when last measured, counted in gauge_
+        std::size_t bytes = 0;
+    };
+
+    // stages fed by a single thread use an SPSC ring, stages fed by the pool put frames back into order through a reorder ring
+    class Inbox {
+      public:
+        Inbox() = default;
+        Inbox(const std::size_t capacity, const bool single_producer) {
+            if (single_producer) {
+                ring_ = std::make_unique<SpscRing<Frame*>>(capacity);
+            } else {
+                reorder_ = std::make_unique<ReorderRing<Frame>>(capacity);
+            }
+        }
+
+        void push(Frame* frame) {
+            if (reorder_) {
+                reorder_->put(frame->sequence, frame);
+                return;
+            }
+
+            // NOTE(will): never full, there are fewer frames in flight than slots.
+            while (!ring_->push(std::move(frame))) {
+                std::this_thread::yield();
+            }
+        }
+
+        Frame* pop(const std::uint64_t sequence) {
+            if (reorder_) {
+                return reorder_->take(sequence);
+            }
+
+            Frame* frame = nullptr;
+            return ring_->pop(frame) ? frame : nullptr;
+        }
+
+      private:
+        std::unique_ptr<SpscRing<Frame*>> ring_;
+        std::unique_ptr<ReorderRing<Frame>> reorder_;
+    };
+
+    struct Stage {
+        bool serial = false;
+        bool single_producer = true;
+        std::vector<ExecutorInterface*> executors;
+        // retained keys each executor records once it's done with a frame
+        std::vector<std::vector<Key>> retained;
+        Inbox inbox;
+    };
+
+    struct Run {
+        explicit Run(Scheduler& pool) : pool(pool) {}
+
+        Scheduler& pool;
+        std::vector<Stage> stages;
+        Inbox completed;
+    };
+
+    void buildStages(Run& run) {
+        for (auto index = std::size_t(0); index < executors_.size(); ++index) {
+            const auto policy = policies_[index];
+            const auto serial = policy != ExecutionPolicy::Parallel && policy != ExecutionPolicy::PerCamera;
+
+            if (serial || run.stages.empty() || run.stages.back().serial) {
+                auto& stage = run.stages.emplace_back();
+                stage.serial = serial;
+                stage.single_producer = run.stages.size() == 1 || run.stages[run.stages.size() - 2].serial;
+            }
+            run.stages.back().executors.emplace_back(executors_[index].get());
+            run.stages.back().retained.emplace_back(recorders_.nodes[index]);
+        }
+    }
+
+    void addRecorders() {
+        std::vector<std::optional<Dependencies>> dependencies;
+        dependencies.reserve(executors_.size());
+        for (const auto& executor : executors_) {
+            dependencies.emplace_back(executor->dependencies());
+        }
+        recorders_ = FrameHistory::recorders(retained_, dependencies);
+    }
+
+    void record(MultiImageContextInterface& multi_context, const std::vector<Key>& keys) {
+        for (const auto& key : keys) {
+            history_.record(multi_context, key);
+        }
+    }
+
+    void process(const Stage& stage, Frame& frame) {
+        for (auto index = std::size_t(0); index < stage.executors.size(); ++index) {
+            stage.executors[index]->process(*frame.context);
+            record(*frame.context, stage.retained[index]);
+        }
+    }
+
+    void emit(Run& run, const std::size_t index, Frame* frame) {
+        if (index == run.stages.size()) {
+            if (!frame->end) {
+                record(*frame->context, recorders_.frame);
+            }
+            run.completed.push(frame);
+        } else if (run.stages[index].serial) {
+            run.stages[index].inbox.push(frame);
+        } else {
+            run.pool.submit([this, &run, index, frame] { runParallel(run, index, frame); });
+        }
+    }
+
+    void runParallel(Run& run, const std::size_t index, Frame* frame) {
+        if (!frame->end) {
+            process(run.stages[index], *frame);
+        }
+        emit(run, index + 1, frame);
+    }
+
+    void runSerial(Run& run, const std::size_t index) {
+        auto& stage = run.stages[index];
+        Backoff backoff;
+
+        for (auto sequence = std::uint64_t(0);; ++sequence) {
+            Frame* frame = nullptr;
+            while ((frame = stage.inbox.pop(sequence)) == nullptr) {
+                backoff.pause();
+            }
+            backoff.reset();
+
+            if (!frame->end) {
+                process(stage, *frame);
+            }
+            emit(run, index + 1, frame);
+
+            if (frame->end) {
+                return;
+            }
+        }
+    }
+
+    void prepareContext(MultiImageContextInterface& multi_context) const {
+        for (const auto& camera : cameras_) {
+            multi_context.cameras(camera);
+        }
+
+        if (multi_context.history() == &history_) {
+            return;
+        }
+
+        for (const auto& [key, fn] : derivations_) {
+            multi_context.derive(key, fn);
+        }
+        multi_context.history(&history_);
+    }
+
+    void complete(const Frame& frame) {
+        num_completed_ += 1;
+        frame_latency_.record(Clock::now() - frame.start);
+    }
+
+    void measure(Frame& frame) { gauge_.measure(*frame.context, frame.bytes); }
+
+    Scheduler& pool() {
+        if (!pool_) {
+            pool_ = std::make_unique<Scheduler>(num_threads_);
+        }
+        return *pool_;
+    }
+
+    unsigned int num_threads_;
+    std::vector<ExecutionPolicy> policies_;
+    std::vector<std::unique_ptr<ExecutorInterface>> executors_;
+    std::vector<CameraId> cameras_;
+    std::vector<std::tuple<Key, ImageContextInterface::FnDerive>> derivations_;
+    FrameHistory history_;
+    MemoryGauge gauge_{history_};
+    std::vector<Key> retained_;
+    FrameHistory::Recorders recorders_;
+    std::mutex initialize_mutex_;
+    std::atomic<std::size_t> num_initialized_ = 0;
+    std::atomic<std::uint64_t> frame_id_ = 0;
+    std::atomic<bool> stopping_ = false;
+
+    std::atomic<std::uint64_t> num_completed_ = 0;
+    LatencyHistogram frame_latency_;
+
+    std::atomic<std::uint64_t> num_throttled_ = 0;
+
+    std::vector<std::unique_ptr<Frame>> frames_;
+    std::unique_ptr<Scheduler> pool_;
+};
+
+std::unique_ptr<PipelineInterface> createStagedPipeline(const unsigned int num_threads) {
+    return std::make_unique<StagedPipeline>(num_threads);
+}
+}  // namespace hastings
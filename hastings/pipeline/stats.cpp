@@ -0,0 +1,78 @@
+#include "hastings/pipeline/stats.h"
+
+#include <algorithm>
+
+namespace hastings {
+
+void LatencyHistogram::record(const Clock::duration duration) {
+    const auto nanoseconds = std::chrono::duration_cast<Duration>(duration).count();
+    const auto value = static_cast<std::uint64_t>(std::max(nanoseconds, Duration::rep(0)));
+    counts_[bucket(value)].fetch_add(1, std::memory_order_relaxed);
+
+    auto max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+}
+
+LatencySummary LatencyHistogram::summary() const {
+    std::array<std::uint64_t, num_buckets> counts;
+    std::uint64_t total = 0;
+    for (auto idx = std::size_t(0); idx < num_buckets; ++idx) {
+        counts[idx] = counts_[idx].load(std::memory_order_relaxed);
+        total += counts[idx];
+    }
+
+    LatencySummary summary;
+    summary.count = total;
+    summary.max = Duration(max_.load(std::memory_order_relaxed));
+    if (total == 0) {
+        return summary;
+    }
+
+    const auto percentile = [&](const double p) {
+        const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(p * total + 0.5));
+
+        std::uint64_t cumulative = 0;
+        for (auto idx = std::size_t(0); idx < num_buckets; ++idx) {
+            cumulative += counts[idx];
+            if (cumulative >= rank) {
+                return std::min(Duration(value(idx)), summary.max);
+            }
+        }
+        return summary.max;
+    };
+
+    summary.p50 = percentile(0.5);
+    summary.p99 = percentile(0.99);
+    summary.p999 = percentile(0.999);
+    return summary;
+}
+
+std::size_t LatencyHistogram::bucket(const std::uint64_t value) {
+    if (value < num_linear) {
+        return value;
+    }
+
+    const auto msb = 63 - __builtin_clzll(value);
+    const auto shift = msb - 4;
+    const auto sub_bucket = (value >> shift) - num_sub_buckets;
+    return num_linear + (msb - 5) * num_sub_buckets + sub_bucket;
+}
+
+std::uint64_t LatencyHistogram::value(const std::size_t bucket) {
+    if (bucket < num_linear) {
+        return bucket;
+    }
+
+    const auto msb = (bucket - num_linear) / num_sub_buckets + 5;
+    const auto sub_bucket = (bucket - num_linear) % num_sub_buckets + num_sub_buckets;
+    const auto shift = msb - 4;
+
+    // NOTE(will): report the middle of the bucket rather than its lower bound
+    return (sub_bucket << shift) + (std::uint64_t(1) << shift) / 2;
+}
+
+LatencyTimer::LatencyTimer(LatencyHistogram& histogram, const Clock::time_point start) : histogram_(histogram), start_(start) {}
+
+LatencyTimer::~LatencyTimer() { histogram_.record(Clock::now() - start_); }
+}  // namespace hastings
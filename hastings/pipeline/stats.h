@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hastings {
+
+struct LatencySummary {
+    using Duration = std::chrono::nanoseconds;
+
+    std::uint64_t count = 0;
+    Duration p50 = Duration::zero();
+    Duration p99 = Duration::zero();
+    Duration p999 = Duration::zero();
+    Duration max = Duration::zero();
+};
+
+// NOTE(will): HDR-style histogram, exact below 32ns and 16 linear sub-buckets per power of two above that (~3% error).
+// recording is a single relaxed increment so it's cheap enough to leave on in every executor.
+class LatencyHistogram {
+  public:
+    using Clock = std::chrono::steady_clock;
+    using Duration = LatencySummary::Duration;
+
+    void record(const Clock::duration duration);
+
+    LatencySummary summary() const;
+
+  private:
+    static constexpr std::size_t num_linear = 32;
+    static constexpr std::size_t num_sub_buckets = 16;
+    static constexpr std::size_t num_buckets = num_linear + (64 - 5) * num_sub_buckets;
+
+    static std::size_t bucket(const std::uint64_t value);
+    static std::uint64_t value(const std::size_t bucket);
+
+    std::array<std::atomic<std::uint64_t>, num_buckets> counts_{};
+    std::atomic<std::uint64_t> max_ = 0;
+};
+
+// records into histogram how long the timer was alive for
+class LatencyTimer {
+  public:
+    using Clock = LatencyHistogram::Clock;
+
+    explicit LatencyTimer(LatencyHistogram& histogram, const Clock::time_point start = Clock::now());
+    ~LatencyTimer();
+
+  private:
+    LatencyHistogram& histogram_;
+    Clock::time_point start_;
+};
+
+struct NodeStats {
+    std::string name;
+    // time spent in the node's process
+    LatencySummary run;
+    // time a frame spent waiting for its turn on the node
+    LatencySummary wait;
+    // time spent in the node's prepare, ahead of its turn
+    LatencySummary prepare;
+};
+
+// NOTE(will): what one frame's context held under a key. images are counted by their buffer, which the frame pool usually hands
+// back to the same key every frame, so a buffer that's new or short-lived points at a key whose size keeps changing.
+struct KeyMemory {
+    // the camera's name, empty for keys of the frame's own context
+    std::string camera;
+    std::string key;
+    std::size_t bytes = 0;
+    // set when the buffer was taken from the heap this frame rather than reused, from the frame pool or the key's last frame
+    bool is_new = false;
+    // frame ids since the key's buffer was last taken from the heap, counting the current one
+    std::uint64_t num_frames = 0;
+};
+
+struct PipelineStats {
+    std::uint64_t num_frames = 0;
+    std::uint64_t num_dropped = 0;
+    LatencySummary frame;
+    // bytes held by the contexts of frames from start, as measured when each frame last finished, plus the frame pool's idle
+    // buffers and images only the frame history still holds
+    std::size_t bytes_in_use = 0;
+    // times a new frame waited because bytes_in_use was over the memory budget
+    std::uint64_t num_throttled = 0;
+    // per-key bytes of a finished frame, sampled every so many frames
+    std::vector<KeyMemory> memory;
+    std::vector<NodeStats> nodes;
+};
+}  // namespace hastings
@@ -2,7 +2,10 @@
 
 #include <array>
 #include <cstdint>
+#include <memory_resource>
+#include <string>
 #include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -35,18 +38,18 @@ struct RectangleGraphic {
 struct TextGraphic {
     Graphic::Color color;
     Graphic::Pixel point;
-    std::string text;
+    std::pmr::string text;
 };
 
 struct VectorGraphic {
     VectorGraphic() = default;
-    VectorGraphic(PointGraphic&& g) : graphic(g) {}
-    VectorGraphic(LineGraphic&& g) : graphic(g) {}
-    VectorGraphic(RectangleGraphic&& g) : graphic(g) {}
-    VectorGraphic(TextGraphic&& g) : graphic(g) {}
+    VectorGraphic(PointGraphic&& g) : graphic(std::move(g)) {}
+    VectorGraphic(LineGraphic&& g) : graphic(std::move(g)) {}
+    VectorGraphic(RectangleGraphic&& g) : graphic(std::move(g)) {}
+    VectorGraphic(TextGraphic&& g) : graphic(std::move(g)) {}
 
     std::variant<PointGraphic, LineGraphic, RectangleGraphic, TextGraphic> graphic;
 };
 
-using VectorGraphics = std::vector<VectorGraphic>;
+using VectorGraphics = std::pmr::vector<VectorGraphic>;
 }  // namespace hastings
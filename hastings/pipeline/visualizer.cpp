@@ -28,7 +28,7 @@ void to_json(json& j, const VectorGraphic& p) {
             } else if constexpr (std::is_same_v<T, RectangleGraphic>) {
                 j = {{"type", "rectangle"}, {"color", arg.color}, {"topLeft", arg.topLeft}, {"bottomRight", arg.bottomRight}};
             } else if constexpr (std::is_same_v<T, TextGraphic>) {
-                j = {{"type", "text"}, {"color", arg.color}, {"point", arg.point}, {"text", arg.text}};
+                j = {{"type", "text"}, {"color", arg.color}, {"point", arg.point}, {"text", std::string(arg.text)}};
             } else {
                 static_assert(always_false_v<T>, "non-exhaustive visitor!");
             }
@@ -64,10 +64,11 @@ void VisualizerStreamerNode::process(MultiImageContextInterface& multi_context)
     {
         ProfilerFunctionMarker marker("serialization");
         std::map<std::string, std::vector<std::string>> cameras;
-        for (const auto& [camera, context] : multi_context.cameras()) {
+        for (const auto& [camera, context, camera_id] : multi_context.cameras()) {
             auto& images = cameras[camera];
 
-            context->images([&images, camera = camera, &stream_config](const std::string& name, const cv::Mat& image) {
+            // NOTE(will): only names are listed, so derived images are only made for the one being streamed
+            context->imageNames([&images, camera = camera, &stream_config](const std::string& name) {
                 images.emplace_back(name);
 
                 if (!stream_config.has_value()) {
@@ -84,7 +85,7 @@ void VisualizerStreamerNode::process(MultiImageContextInterface& multi_context)
         if (stream_config.has_value()) {
             const auto config = stream_config.value();
             const auto context = multi_context.cameras(config.camera);
-            const auto image = context->image(config.image);
+            const auto& image = context->view(config.image);
             const auto& graphics = context->vectorGraphic(config.image);
 
             std::vector<std::uint8_t> buffer;
@@ -22,4 +22,73 @@ ExecutionPolicy ParallelNode::executionPolicy() const { return ExecutionPolicy::
 std::string ParallelNode::name() const { return "ParallelNode"; }
 
 void ParallelNode::process(MultiImageContextInterface& multi_context) { multi_context.result("frameOrdering") = std::vector<int>{}; };
+
+std::string CameraNode::name() const { return "CameraNode"; }
+
+void CameraNode::processCamera(const std::string& camera, ImageContextInterface& context) { context.result("camera") = camera; };
+
+std::string CameraStateNode::name() const { return "CameraStateNode"; }
+
+void CameraStateNode::processCamera(const std::string& camera, ImageContextInterface& context, std::vector<int>& frame_ordering) {
+    frame_ordering.emplace_back(context.frameId());
+    context.result("frameOrdering") = frame_ordering;
+};
+
+AsyncNode::AsyncNode(const ExecutionPolicy policy) : policy_(policy), thread_([this] { complete(); }) {}
+
+AsyncNode::~AsyncNode() {
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+}
+
+ExecutionPolicy AsyncNode::executionPolicy() const { return policy_; }
+std::string AsyncNode::name() const { return "AsyncNode"; }
+
+void AsyncNode::processAsync(MultiImageContextInterface& multi_context, FnDone&& done) {
+    {
+        std::lock_guard lock(mutex_);
+        requests_.emplace_back(&multi_context, std::move(done));
+    }
+    cv_.notify_one();
+}
+
+void AsyncNode::complete() {
+    while (true) {
+        std::unique_lock lock(mutex_);
+        cv_.wait(lock, [this] { return stop_ || !requests_.empty(); });
+        if (requests_.empty()) {
+            return;
+        }
+
+        auto [multi_context, done] = std::move(requests_.front());
+        requests_.pop_front();
+        lock.unlock();
+
+        frame_ordering_.emplace_back(multi_context->frameId());
+        multi_context->result("frameOrdering") = frame_ordering_;
+        done();
+    }
+}
+
+BatchNode::BatchNode(const std::size_t batch_size, const Duration batch_timeout)
+    : batch_size_(batch_size), batch_timeout_(batch_timeout) {}
+
+std::string BatchNode::name() const { return "BatchNode"; }
+std::size_t BatchNode::batchSize() const { return batch_size_; }
+BatchNode::Duration BatchNode::batchTimeout() const { return batch_timeout_; }
+
+void BatchNode::processBatch(const Batch& batch) {
+    for (auto multi_context : batch) {
+        frame_ordering_.emplace_back(multi_context->frameId());
+    }
+
+    for (auto multi_context : batch) {
+        multi_context->result("frameOrdering") = frame_ordering_;
+        multi_context->result("batchSize") = batch.size();
+    }
+};
 }  // namespace hastings
\ No newline at end of file
@@ -3,6 +3,11 @@
 #include <hastings/pipeline/context.h>
 #include <hastings/pipeline/node.h>
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 namespace hastings {
 struct OrderedNode final : NodeInterface {
     ExecutionPolicy executionPolicy() const override final;
@@ -31,4 +36,53 @@ struct ParallelNode final : NodeInterface {
 
     void process(MultiImageContextInterface& multi_context) override final;
 };
+
+struct CameraNode final : CameraNodeInterface {
+    std::string name() const override final;
+
+    void processCamera(const std::string& camera, ImageContextInterface& context) override final;
+};
+
+struct CameraStateNode final : CameraStateNodeInterface<std::vector<int>> {
+    std::string name() const override final;
+
+    void processCamera(const std::string& camera, ImageContextInterface& context, std::vector<int>& frame_ordering) override final;
+};
+
+// completes every frame on its own I/O thread, standing in for a node waiting on a device or socket
+struct AsyncNode final : AsyncNodeInterface {
+    explicit AsyncNode(ExecutionPolicy policy);
+    ~AsyncNode();
+
+    ExecutionPolicy executionPolicy() const override final;
+    std::string name() const override final;
+
+    void processAsync(MultiImageContextInterface& multi_context, FnDone&& done) override final;
+
+  private:
+    void complete();
+
+    ExecutionPolicy policy_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::deque<std::tuple<MultiImageContextInterface*, FnDone>> requests_;
+    std::vector<int> frame_ordering_;
+    std::thread thread_;
+};
+
+struct BatchNode final : BatchNodeInterface {
+    BatchNode(std::size_t batch_size, Duration batch_timeout);
+
+    std::string name() const override final;
+    std::size_t batchSize() const override final;
+    Duration batchTimeout() const override final;
+
+    void processBatch(const Batch& batch) override final;
+
+  private:
+    std::size_t batch_size_;
+    Duration batch_timeout_;
+    std::vector<int> frame_ordering_;
+};
 }  // namespace hastings
\ No newline at end of file
@@ -1,5 +1,17 @@
 #include <gtest/gtest.h>
 #include <hastings/pipeline/context.h>
+#include <hastings/pipeline/frame_pool.h>
+
+#include <algorithm>
+#include <any>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 TEST(ImageContext, Construction) {
     using hastings::createImageContext;
@@ -160,6 +172,174 @@ TEST(ImageContext, ImageConstGet) {
     });
 }
 
+TEST(ImageContext, Key) {
+    using hastings::createImageContext;
+    using hastings::Key;
+
+    const auto context = createImageContext();
+    const Key key("value_a");
+
+    context->result(key) = 100;
+    EXPECT_EQ(context->result<int>("value_a"), 100);
+
+    context->result("value_a") = 150;
+    EXPECT_EQ(context->result<int>(key), 150);
+}
+
+TEST(ImageContext, ImageKey) {
+    using hastings::createImageContext;
+    using hastings::Key;
+
+    const auto context = createImageContext();
+    const Key key("BGR");
+
+    context->image(key) = cv::Mat::zeros({10, 12}, CV_8UC3);
+    EXPECT_EQ(&context->image("BGR"), &context->image(key));
+
+    auto num_images = 0;
+    context->images([&num_images](const std::string& name, cv::Mat& image) {
+        EXPECT_EQ(name, "BGR");
+        num_images += 1;
+    });
+    EXPECT_EQ(num_images, 1);
+
+    context->clear();
+    EXPECT_EQ(context->image(key).rows, 0);
+}
+
+// NOTE(will): taking every Key would break the tests after this one, so it runs in a child process.
+TEST(ImageContextDeathTest, KeysExhausted) {
+    using hastings::createImageContext;
+    using hastings::Key;
+
+    const auto exhaust = [] {
+        for (auto idx = std::size_t(0); idx <= Key::max_keys; ++idx) {
+            if (!Key::tryIntern("keys-exhausted-" + std::to_string(idx)).has_value()) {
+                break;
+            }
+        }
+
+        const auto context = createImageContext();
+        context->result("overflow-value") = 100;
+        context->image("overflow-image") = cv::Mat::zeros({10, 12}, CV_8UC3);
+        context->vectorGraphic("overflow-image", {});
+
+        auto num_images = 0;
+        context->images([&num_images](const std::string& name, const cv::Mat& image) { num_images += name == "overflow-image"; });
+
+        const auto is_kept = context->result<int>("overflow-value") == 100 && context->image("overflow-image").rows == 12;
+        context->clear();
+        const auto is_cleared = !context->result("overflow-value").has_value() && context->image("overflow-image").empty();
+        std::exit(num_images == 1 && is_kept && is_cleared && !Key::tryIntern("overflow-value").has_value() ? 0 : 1);
+    };
+
+    EXPECT_EXIT(exhaust(), testing::ExitedWithCode(0), "");
+}
+
+TEST(ImageContext, TypedResult) {
+    using hastings::createImageContext;
+    using hastings::ResultKey;
+
+    const auto context = createImageContext();
+    const ResultKey<std::vector<int>> key("typed_a");
+
+    EXPECT_TRUE(context->result(key).empty());
+    context->result(key).assign(100, 1);
+    EXPECT_EQ(context->result(key).size(), 100);
+
+    // NOTE(will): typed results don't share storage with the std::any result of the same name
+    EXPECT_FALSE(context->result("typed_a").has_value());
+}
+
+TEST(ImageContext, TypedResultKeepsCapacity) {
+    using hastings::createImageContext;
+    using hastings::ResultKey;
+
+    const auto context = createImageContext();
+    const ResultKey<std::vector<int>> vector_key("typed_vector");
+    const ResultKey<int> int_key("typed_int");
+
+    context->result(vector_key).assign(100, 1);
+    const auto data = context->result(vector_key).data();
+    context->result(int_key) = 12;
+
+    context->clear();
+    EXPECT_TRUE(context->result(vector_key).empty());
+    EXPECT_GE(context->result(vector_key).capacity(), 100);
+    EXPECT_EQ(context->result(int_key), 0);
+
+    context->result(vector_key).assign(50, 2);
+    EXPECT_EQ(context->result(vector_key).data(), data);
+}
+
+TEST(ImageContext, Alias) {
+    using hastings::createImageContext;
+    using hastings::Key;
+
+    const auto context = createImageContext();
+    const Key bgr("BGR");
+    const Key other("other BGR");
+
+    context->image(bgr) = cv::Mat::zeros({10, 12}, CV_8UC3);
+    context->alias(other, bgr);
+
+    EXPECT_EQ(context->view(other).data, context->view(bgr).data);
+    EXPECT_EQ(context->view(other).rows, 12);
+}
+
+TEST(ImageContext, AliasViewByName) {
+    using hastings::createImageContext;
+    using hastings::Key;
+
+    const auto context = createImageContext();
+    context->image("BGR") = cv::Mat::zeros({10, 12}, CV_8UC3);
+    context->alias(Key("other BGR"), Key("BGR"));
+
+    EXPECT_EQ(context->view("other BGR").data, context->view("BGR").data);
+}
+
+TEST(ImageContext, AliasCopyOnWrite) {
+    using hastings::createImageContext;
+    using hastings::Key;
+
+    const auto context = createImageContext();
+    const Key bgr("BGR");
+    const Key other("other BGR");
+
+    context->image(bgr) = cv::Mat::zeros({10, 12}, CV_8UC1);
+    const auto data = context->view(bgr).data;
+    context->alias(other, bgr);
+
+    auto& written = context->image(other);
+    written.at<uchar>(0, 0) = 42;
+
+    EXPECT_NE(written.data, data);
+    EXPECT_EQ(context->view(bgr).data, data);
+    EXPECT_EQ(context->view(bgr).data[0], 0);
+
+    // NOTE(will): the source no longer shares its buffer, so writing to it doesn't copy
+    EXPECT_EQ(context->image(bgr).data, data);
+}
+
+TEST(ImageContext, AliasSourceWrite) {
+    using hastings::createImageContext;
+    using hastings::Key;
+
+    const auto context = createImageContext();
+    const Key bgr("BGR");
+    const Key other("other BGR");
+
+    context->image(bgr) = cv::Mat::zeros({10, 12}, CV_8UC1);
+    const auto data = context->view(bgr).data;
+    context->alias(other, bgr);
+
+    context->image(bgr).at<uchar>(0, 0) = 42;
+
+    EXPECT_EQ(context->view(other).data, data);
+    EXPECT_EQ(context->view(other).data[0], 0);
+    EXPECT_EQ(context->view(bgr).data[0], 42);
+}
+
 TEST(ImageContext, VectorGraphicsExistingImage) {
     using hastings::createImageContext;
     using hastings::VectorGraphics;
@@ -205,6 +385,63 @@ TEST(ImageContext, VectorGraphicsNoCamera) {
     ASSERT_THROW({ context->vectorGraphic("BGR"); }, std::out_of_range);
 }
 
+TEST(ImageContext, Derive) {
+    using hastings::createImageContext;
+    using hastings::ImageContextInterface;
+    using hastings::Key;
+
+    const auto context = createImageContext();
+    const Key bgr("BGR");
+    const Key y("Y");
+
+    auto num_derived = 0;
+    context->derive(y, [&num_derived, bgr](ImageContextInterface& context, cv::Mat& image) {
+        num_derived += 1;
+        context.view(bgr).copyTo(image);
+    });
+
+    context->image(bgr) = cv::Mat::zeros({10, 12}, CV_8UC1);
+    EXPECT_EQ(num_derived, 0);
+
+    EXPECT_EQ(context->view(y).rows, 12);
+    EXPECT_EQ(context->image(y).rows, 12);
+    EXPECT_EQ(num_derived, 1);
+
+    // NOTE(will): a frame that never reads it doesn't make it
+    context->clear();
+    context->image(bgr) = cv::Mat::zeros({10, 12}, CV_8UC1);
+    context->clear();
+    EXPECT_EQ(num_derived, 1);
+
+    context->image(bgr) = cv::Mat::zeros({20, 24}, CV_8UC1);
+    EXPECT_EQ(context->view(y).rows, 24);
+    EXPECT_EQ(num_derived, 2);
+}
+
+TEST(ImageContext, DerivedImageNames) {
+    using hastings::createImageContext;
+    using hastings::ImageContextInterface;
+    using hastings::Key;
+
+    const auto context = createImageContext();
+    context->derive(Key("Y"), [](ImageContextInterface& context, cv::Mat& image) { image = cv::Mat::zeros({4, 4}, CV_8UC1); });
+    context->image("BGR");
+
+    std::vector<std::string> names;
+    context->imageNames([&names](const std::string& name) { names.emplace_back(name); });
+    std::sort(names.begin(), names.end());
+    EXPECT_EQ(names, (std::vector<std::string>{"BGR", "Y"}));
+
+    // a derived image isn't listed until something made it
+    auto num_images = 0;
+    context->images([&num_images](const std::string& name, const cv::Mat& image) { num_images += 1; });
+    EXPECT_EQ(num_images, 1);
+
+    context->view(Key("Y"));
+    context->images([&num_images](const std::string& name, const cv::Mat& image) { num_images += 1; });
+    EXPECT_EQ(num_images, 3);
+}
+
 TEST(MultiImageContext, Construction) {
     using hastings::createMultiImageContext;
 
@@ -223,6 +460,21 @@ TEST(MultiImageContext, getCamera) {
     EXPECT_EQ(camera_ptr_a, camera_ptr_b);
 }
 
+TEST(MultiImageContext, getCameraById) {
+    using hastings::CameraId;
+    using hastings::createMultiImageContext;
+
+    const auto context = createMultiImageContext();
+    context->frameId(12);
+
+    const CameraId camera("camera_a");
+    auto camera_ptr = context->cameras(camera);
+
+    EXPECT_EQ(camera_ptr, context->cameras("camera_a"));
+    EXPECT_EQ(camera_ptr->frameId(), 12);
+    EXPECT_EQ(std::get<2>(context->cameras().front()), camera);
+}
+
 TEST(MultiImageContext, cameras) {
     using hastings::createMultiImageContext;
     using Camera = hastings::MultiImageContextInterface::Camera;
@@ -242,6 +494,57 @@ TEST(MultiImageContext, cameras) {
     EXPECT_EQ(std::get<1>(cameras[1]).get(), camera_ptr_b);
 }
 
+TEST(MultiImageContextDeathTest, CamerasExhausted) {
+    using hastings::CameraId;
+    using hastings::createMultiImageContext;
+
+    const auto exhaust = [] {
+        for (auto idx = std::size_t(0); idx <= CameraId::max_cameras; ++idx) {
+            if (!CameraId::tryIntern("cameras-exhausted-" + std::to_string(idx)).has_value()) {
+                break;
+            }
+        }
+
+        // NOTE(will): a camera past the registry is still made by name, it's kept by the context but not listed by cameras()
+        const auto multi_context = createMultiImageContext();
+        multi_context->frameId(3);
+        const auto camera = multi_context->cameras("overflow-camera");
+        camera->image("BGR") = cv::Mat::zeros({4, 4}, CV_8UC1);
+
+        const auto is_kept = multi_context->cameras("overflow-camera") == camera && camera->frameId() == 3 && !camera->view("BGR").empty();
+        const auto is_counted = multi_context->bytes() == 16 && multi_context->memory().size() == 1;
+        multi_context->clear();
+        const auto is_cleared = camera->view("BGR").empty();
+        std::exit(is_kept && is_counted && is_cleared && multi_context->cameras().empty() ? 0 : 1);
+    };
+
+    EXPECT_EXIT(exhaust(), testing::ExitedWithCode(0), "");
+}
+
+TEST(MultiImageContext, camerasWhileMaking) {
+    using hastings::createMultiImageContext;
+
+    // NOTE(will): relying on tsan to find data races, a snapshot only ever holds cameras that are fully made.
+    const auto context = createMultiImageContext();
+    std::thread making([&context] {
+        for (auto idx = 0; idx < 8; ++idx) {
+            context->cameras("making_" + std::to_string(idx));
+        }
+    });
+
+    auto num_seen = std::size_t(0);
+    while (num_seen < 8) {
+        const auto cameras = context->cameras();
+        for (const auto& [name, camera_context, camera] : cameras) {
+            EXPECT_NE(camera_context, nullptr);
+            EXPECT_EQ(name, camera.name());
+        }
+        EXPECT_GE(cameras.size(), num_seen);
+        num_seen = cameras.size();
+    }
+    making.join();
+}
+
 TEST(MultiImageContext, frameId) {
     using hastings::createMultiImageContext;
     const auto context = createMultiImageContext();
@@ -297,6 +600,44 @@ TEST(MultiImageContext, clearCameraResult) {
     EXPECT_FALSE(context->cameras("camera")->result("test-other").has_value());
 }
 
+TEST(MultiImageContext, clearTypedResult) {
+    using hastings::createMultiImageContext;
+    using hastings::ResultKey;
+
+    const auto context = createMultiImageContext();
+    const ResultKey<std::string> key("typed_string");
+
+    context->result(key) = "hello-world";
+    context->cameras("camera")->result(key) = "hello-camera";
+    EXPECT_EQ(context->result(key), "hello-world");
+    EXPECT_EQ(context->cameras("camera")->result(key), "hello-camera");
+
+    context->clear();
+    EXPECT_TRUE(context->result(key).empty());
+    EXPECT_TRUE(context->cameras("camera")->result(key).empty());
+}
+
+TEST(MultiImageContext, aliasCamera) {
+    using hastings::createMultiImageContext;
+    using hastings::Key;
+
+    const auto context = createMultiImageContext();
+    const Key bgr("BGR");
+
+    auto camera_a = context->cameras("camera_a");
+    auto camera_b = context->cameras("camera_b");
+
+    camera_a->image(bgr) = cv::Mat::zeros({10, 12}, CV_8UC3);
+    camera_b->alias(bgr, *camera_a, bgr);
+    EXPECT_EQ(camera_b->view(bgr).data, camera_a->view(bgr).data);
+
+    context->clear();
+    EXPECT_TRUE(camera_b->view(bgr).empty());
+
+    camera_b->image(bgr) = cv::Mat::zeros({10, 12}, CV_8UC3);
+    EXPECT_NE(camera_b->view(bgr).data, camera_a->view(bgr).data);
+}
+
 TEST(MultiImageContext, clearGraphics) {
     using hastings::createMultiImageContext;
     using hastings::VectorGraphics;
@@ -322,4 +663,203 @@ TEST(MultiImageContext, clearCameraGraphics) {
 
     context->clear();
     EXPECT_EQ(cameraContext->vectorGraphic("BGR").size(), 0);
-}
\ No newline at end of file
+}
+
+TEST(ImageContext, Memory) {
+    using hastings::createImageContext;
+    using hastings::Key;
+    using hastings::KeyMemory;
+    using hastings::ResultKey;
+
+    // NOTE(will): entries come in key id order, which depends on what other tests interned first.
+    const auto entry = [](const std::vector<KeyMemory>& memory, const std::string& key) {
+        return *std::find_if(memory.begin(), memory.end(), [&key](const KeyMemory& entry) { return entry.key == key; });
+    };
+
+    // NOTE(will): buffers other tests left in the pool would be reused rather than taken from the heap.
+    hastings::framePool().trim(0);
+
+    const auto context = createImageContext();
+    const ResultKey<std::vector<int>> peaks("ImageContext.Memory peaks");
+
+    context->frameId(0);
+    context->image("BGR").create(10, 20, CV_8UC3);
+    context->alias(Key("other BGR"), Key("BGR"));
+    context->result(peaks).reserve(100);
+
+    auto memory = context->memory();
+    ASSERT_EQ(memory.size(), 2);
+    EXPECT_EQ(entry(memory, "BGR").bytes, 10 * 20 * 3);
+    EXPECT_TRUE(entry(memory, "BGR").is_new);
+    EXPECT_EQ(entry(memory, "BGR").num_frames, 1);
+    EXPECT_GE(entry(memory, peaks.name()).bytes, 100 * sizeof(int));
+    EXPECT_EQ(context->bytes(), memory[0].bytes + memory[1].bytes);
+
+    // NOTE(will): the frame pool hands the key its buffer back, so it carries on living
+    context->clear();
+    context->frameId(1);
+    context->image("BGR").create(10, 20, CV_8UC3);
+
+    memory = context->memory();
+    ASSERT_EQ(memory.size(), 2);
+    EXPECT_FALSE(entry(memory, "BGR").is_new);
+    EXPECT_EQ(entry(memory, "BGR").num_frames, 2);
+    EXPECT_FALSE(entry(memory, peaks.name()).is_new);
+
+    context->clear();
+    context->frameId(2);
+    context->image("BGR").create(20, 20, CV_8UC3);
+
+    memory = context->memory();
+    EXPECT_TRUE(entry(memory, "BGR").is_new);
+    EXPECT_EQ(entry(memory, "BGR").num_frames, 1);
+}
+
+TEST(ImageContext, MemoryPooledFromOtherContext) {
+    using hastings::createImageContext;
+    using hastings::KeyMemory;
+
+    const auto is_new = [](const std::vector<KeyMemory>& memory, const std::string& key) {
+        return std::find_if(memory.begin(), memory.end(), [&key](const KeyMemory& entry) { return entry.key == key; })->is_new;
+    };
+
+    hastings::framePool().trim(0);
+
+    const auto context_a = createImageContext();
+    context_a->image("BGR").create(11, 21, CV_8UC3);
+    const auto data = context_a->image("BGR").data;
+    context_a->clear();
+
+    // NOTE(will): the buffer context_a let go of is handed on rather than taken from the heap, so it isn't new to context_b.
+    const auto context_b = createImageContext();
+    context_b->image("BGR").create(11, 21, CV_8UC3);
+    ASSERT_EQ(context_b->image("BGR").data, data);
+    EXPECT_FALSE(is_new(context_b->memory(), "BGR"));
+
+    context_b->image("other BGR").create(11, 21, CV_8UC3);
+    EXPECT_TRUE(is_new(context_b->memory(), "other BGR"));
+}
+
+TEST(MultiImageContext, memory) {
+    using hastings::createMultiImageContext;
+
+    const auto context = createMultiImageContext();
+    context->image("BGR").create(10, 20, CV_8UC3);
+    context->cameras("camera_a")->image("Y").create(10, 20, CV_8UC1);
+
+    const auto memory = context->memory();
+    ASSERT_EQ(memory.size(), 2);
+    EXPECT_EQ(memory[0].camera, "");
+    EXPECT_EQ(memory[0].key, "BGR");
+    EXPECT_EQ(memory[1].camera, "camera_a");
+    EXPECT_EQ(memory[1].key, "Y");
+    EXPECT_EQ(context->bytes(), 10 * 20 * 4);
+}
+
+TEST(MultiImageContext, derive) {
+    using hastings::createMultiImageContext;
+    using hastings::ImageContextInterface;
+    using hastings::Key;
+
+    const auto context = createMultiImageContext();
+    const Key y("Y");
+    const auto derive = [](ImageContextInterface& context, cv::Mat& image) { image = cv::Mat::zeros({4, 4}, CV_8UC1); };
+
+    const auto camera_a = context->cameras("camera_a");
+    context->derive(y, derive);
+    const auto camera_b = context->cameras("camera_b");
+
+    EXPECT_FALSE(context->view(y).empty());
+    EXPECT_FALSE(camera_a->view(y).empty());
+    EXPECT_FALSE(camera_b->view(y).empty());
+}
+
+namespace {
+// NOTE(will): the context as it was before keys were interned, a mutex guarded std::map per kind of entry.
+class MapContext {
+  public:
+    std::any& result(const std::string& name) {
+        std::lock_guard lock(mutex_);
+        return data_[name];
+    }
+
+  private:
+    std::mutex mutex_;
+    std::map<std::string, std::any> data_;
+};
+
+template <class FnLookup>
+double lookupLatency(const std::size_t num_keys, const std::size_t num_lookups, const FnLookup& fn_lookup) {
+    const auto start = std::chrono::steady_clock::now();
+    for (auto lookup = std::size_t(0); lookup < num_lookups; ++lookup) {
+        fn_lookup(lookup % num_keys);
+    }
+    const auto duration = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(duration).count() / num_lookups;
+}
+}  // namespace
+
+TEST(ContextBenchmark, LookupLatency) {
+    using hastings::createImageContext;
+    using hastings::Key;
+
+    const auto num_keys = std::size_t(32);
+    const auto num_lookups = std::size_t(1000000);
+
+    std::vector<std::string> names;
+    std::vector<Key> keys;
+    for (auto idx = std::size_t(0); idx < num_keys; ++idx) {
+        names.emplace_back("benchmark result " + std::to_string(idx));
+        keys.emplace_back(names.back());
+    }
+
+    MapContext map_context;
+    const auto context = createImageContext();
+
+    auto num_values = std::size_t(0);
+    const auto map_latency =
+        lookupLatency(num_keys, num_lookups, [&](const std::size_t idx) { num_values += map_context.result(names[idx]).has_value(); });
+    const auto string_latency =
+        lookupLatency(num_keys, num_lookups, [&](const std::size_t idx) { num_values += context->result(names[idx]).has_value(); });
+    const auto key_latency =
+        lookupLatency(num_keys, num_lookups, [&](const std::size_t idx) { num_values += context->result(keys[idx]).has_value(); });
+    EXPECT_EQ(num_values, 0);
+
+    std::cout << "[ lookup ] map: " << map_latency << "ns string: " << string_latency << "ns key: " << key_latency << "ns" << std::endl;
+    RecordProperty("map_ns", std::to_string(map_latency));
+    RecordProperty("string_ns", std::to_string(string_latency));
+    RecordProperty("key_ns", std::to_string(key_latency));
+}
+
+TEST(ContextBenchmark, ResultReuse) {
+    using hastings::createImageContext;
+    using hastings::ResultKey;
+
+    const auto num_frames = 20000;
+    const auto num_detections = 256;
+
+    const auto context = createImageContext();
+    const ResultKey<std::vector<float>> key("benchmark detections");
+
+    // NOTE(will): the std::any result is rebuilt every frame, the typed result is cleared in place and refilled.
+    const auto any_latency = lookupLatency(1, num_frames, [&](const std::size_t) {
+        std::vector<float> detections;
+        for (auto idx = 0; idx < num_detections; ++idx) {
+            detections.emplace_back(float(idx));
+        }
+        context->result("benchmark detections") = std::move(detections);
+        context->clear();
+    });
+
+    const auto typed_latency = lookupLatency(1, num_frames, [&](const std::size_t) {
+        auto& detections = context->result(key);
+        for (auto idx = 0; idx < num_detections; ++idx) {
+            detections.emplace_back(float(idx));
+        }
+        context->clear();
+    });
+
+    std::cout << "[ result ] any: " << any_latency << "ns typed: " << typed_latency << "ns" << std::endl;
+    RecordProperty("any_ns", std::to_string(any_latency));
+    RecordProperty("typed_ns", std::to_string(typed_latency));
+}
@@ -2,6 +2,10 @@
 #include <gtest/gtest.h>
 #include <hastings/pipeline/executors.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <numeric>
 #include <thread>
 
@@ -145,4 +149,918 @@ TEST(ParallelExecutor, Process) {
 
     const auto num_threads = 100;
     const auto frame_ordering = process(num_threads, &executor);
-}
\ No newline at end of file
+}
+
+std::vector<std::vector<int>> schedule(const int num_frames, hastings::ExecutorInterface* executor) {
+    std::vector<hastings::MultiImageContextInterface::Ptr> contexts;
+    contexts.reserve(num_frames);
+
+    std::mutex mutex;
+    std::vector<std::vector<int>> results;
+    std::atomic<int> num_completed = 0;
+
+    {
+        hastings::Scheduler scheduler(8);
+        for (auto idx = num_frames - 1; idx >= 0; --idx) {
+            auto& context = contexts.emplace_back(hastings::createMultiImageContext());
+            context->frameId(idx);
+
+            scheduler.submit([&, executor, context = context.get()] {
+                executor->schedule(*context, scheduler, [&mutex, &results, &num_completed, context] {
+                    {
+                        std::lock_guard lock(mutex);
+                        results.emplace_back(context->result<std::vector<int>>("frameOrdering"));
+                    }
+                    num_completed += 1;
+                });
+            });
+        }
+
+        // NOTE(will): async nodes complete off the pool, so the scheduler has to outlive every continuation.
+        while (num_completed < num_frames) {
+            std::this_thread::yield();
+        }
+    }
+
+    return results;
+}
+
+TEST(OrderedExecutor, Schedule) {
+    using hastings::OrderedExecutor;
+    using hastings::OrderedNode;
+
+    auto executor = OrderedExecutor(std::make_unique<OrderedNode>());
+
+    const auto num_frames = 100;
+    const auto frame_ordering = schedule(num_frames, &executor);
+
+    std::vector<int> expected_ordering(num_frames);
+    std::iota(expected_ordering.begin(), expected_ordering.end(), 0);
+
+    ASSERT_EQ(frame_ordering.size(), num_frames);
+
+    // NOTE(will): continuations race each other, but each frame saw exactly the frames before it go through the node.
+    for (const auto& ordering : frame_ordering) {
+        ASSERT_FALSE(ordering.empty());
+        EXPECT_THAT(ordering, testing::ElementsAreArray(expected_ordering.begin(), expected_ordering.begin() + ordering.size()));
+    }
+}
+
+TEST(UnorderedExecutor, Schedule) {
+    using hastings::UnorderedExecutor;
+    using hastings::UnorderedNode;
+
+    auto executor = UnorderedExecutor(std::make_unique<UnorderedNode>());
+
+    const auto num_frames = 100;
+    const auto frame_ordering = schedule(num_frames, &executor);
+
+    std::vector<int> expected_ordering(num_frames);
+    std::iota(expected_ordering.begin(), expected_ordering.end(), 0);
+
+    ASSERT_EQ(frame_ordering.size(), num_frames);
+
+    // NOTE(will): continuations race each other, so the last frame through the node has the longest ordering.
+    const auto& last = *std::max_element(frame_ordering.begin(), frame_ordering.end(),
+                                         [](const auto& lhs, const auto& rhs) { return lhs.size() < rhs.size(); });
+    EXPECT_THAT(last, testing::UnorderedElementsAreArray(expected_ordering));
+}
+
+TEST(ParallelExecutor, Schedule) {
+    using hastings::ParallelExecutor;
+    using hastings::ParallelNode;
+
+    auto executor = ParallelExecutor(std::make_unique<ParallelNode>());
+
+    const auto num_frames = 100;
+    const auto frame_ordering = schedule(num_frames, &executor);
+
+    EXPECT_EQ(frame_ordering.size(), num_frames);
+}
+
+TEST(ParallelExecutor, ScheduleOverlaps) {
+    using hastings::ExecutionPolicy;
+    using hastings::MultiImageContextInterface;
+    using hastings::ParallelExecutor;
+
+    // NOTE(will): each frame waits a while for another to be in the node with it, which only happens if frames overlap.
+    struct OverlapNode final : hastings::NodeInterface {
+        ExecutionPolicy executionPolicy() const override final { return ExecutionPolicy::Parallel; }
+        std::string name() const override final { return "OverlapNode"; }
+
+        void process(MultiImageContextInterface& multi_context) override final {
+            num_running += 1;
+
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (!overlapped && std::chrono::steady_clock::now() < deadline) {
+                overlapped = overlapped || num_running >= 2;
+                std::this_thread::yield();
+            }
+
+            num_running -= 1;
+            multi_context.result("frameOrdering") = std::vector<int>{};
+        }
+
+        std::atomic<int> num_running = 0;
+        std::atomic<bool> overlapped = false;
+    };
+
+    auto node = std::make_unique<OverlapNode>();
+    const auto& overlap = *node;
+    auto executor = ParallelExecutor(std::move(node));
+
+    const auto frame_ordering = schedule(16, &executor);
+
+    EXPECT_EQ(frame_ordering.size(), 16);
+    EXPECT_TRUE(overlap.overlapped);
+}
+
+TEST(OrderedExecutor, Skip) {
+    using hastings::OrderedExecutor;
+    using hastings::OrderedNode;
+
+    auto executor = OrderedExecutor(std::make_unique<OrderedNode>());
+
+    const auto skipped = hastings::createMultiImageContext();
+    skipped->frameId(1);
+    executor.skip(*skipped);
+
+    const auto context_0 = hastings::createMultiImageContext();
+    const auto context_2 = hastings::createMultiImageContext();
+    context_0->frameId(0);
+    context_2->frameId(2);
+
+    std::thread thread([&] { executor.process(*context_2); });
+    executor.process(*context_0);
+    thread.join();
+
+    EXPECT_THAT(context_2->result<std::vector<int>>("frameOrdering"), testing::ElementsAre(0, 2));
+}
+
+TEST(OrderedExecutor, Stats) {
+    using hastings::OrderedExecutor;
+    using hastings::OrderedNode;
+
+    auto executor = OrderedExecutor(std::make_unique<OrderedNode>());
+    process(10, &executor);
+
+    const auto stats = executor.stats();
+    EXPECT_EQ(stats.name, "OrderedNode");
+    EXPECT_EQ(stats.run.count, 10);
+    EXPECT_EQ(stats.wait.count, 10);
+}
+
+TEST(OrderedExecutor, Prepare) {
+    using hastings::ExecutionPolicy;
+    using hastings::MultiImageContextInterface;
+    using hastings::NodeInterface;
+    using hastings::OrderedExecutor;
+
+    // NOTE(will): frame 0's process waits on frame 1's prepare, which deadlocks if prepare is serialised with process.
+    struct PrepareNode final : NodeInterface {
+        ExecutionPolicy executionPolicy() const override final { return ExecutionPolicy::Ordered; }
+        std::string name() const override final { return "PrepareNode"; }
+
+        void prepare(MultiImageContextInterface& multi_context) override final {
+            multi_context.result("prepared") = true;
+            if (multi_context.frameId() == 1) {
+                second_prepared = true;
+            }
+        }
+
+        void process(MultiImageContextInterface& multi_context) override final {
+            EXPECT_TRUE(multi_context.result<bool>("prepared"));
+
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (!second_prepared && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+        }
+
+        std::atomic<bool> second_prepared = false;
+    };
+
+    auto node = std::make_unique<PrepareNode>();
+    const auto& second_prepared = node->second_prepared;
+    auto executor = OrderedExecutor(std::move(node));
+
+    const auto context_0 = hastings::createMultiImageContext();
+    const auto context_1 = hastings::createMultiImageContext();
+    context_0->frameId(0);
+    context_1->frameId(1);
+
+    std::thread thread([&] { executor.process(*context_1); });
+    executor.process(*context_0);
+    thread.join();
+
+    EXPECT_TRUE(second_prepared);
+    EXPECT_EQ(executor.stats().prepare.count, 2);
+}
+
+TEST(UnorderedExecutor, Stats) {
+    using hastings::UnorderedExecutor;
+    using hastings::UnorderedNode;
+
+    auto executor = UnorderedExecutor(std::make_unique<UnorderedNode>());
+    schedule(10, &executor);
+
+    const auto stats = executor.stats();
+    EXPECT_EQ(stats.name, "UnorderedNode");
+    EXPECT_EQ(stats.run.count, 10);
+    EXPECT_EQ(stats.wait.count, 10);
+}
+
+TEST(ParallelExecutor, Stats) {
+    using hastings::ParallelExecutor;
+    using hastings::ParallelNode;
+
+    auto executor = ParallelExecutor(std::make_unique<ParallelNode>());
+    process(10, &executor);
+
+    const auto stats = executor.stats();
+    EXPECT_EQ(stats.name, "ParallelNode");
+    EXPECT_EQ(stats.run.count, 10);
+    EXPECT_EQ(stats.wait.count, 0);
+}
+
+TEST(PerCameraExecutor, Constructor) {
+    using hastings::CameraNode;
+    using hastings::PerCameraExecutor;
+
+    EXPECT_NO_THROW(PerCameraExecutor(std::make_unique<CameraNode>()));
+}
+
+TEST(PerCameraExecutor, ConstructorBadNode) {
+    using hastings::ParallelNode;
+    using hastings::PerCameraExecutor;
+
+    EXPECT_THROW(PerCameraExecutor(std::make_unique<ParallelNode>()), std::invalid_argument);
+}
+
+TEST(PerCameraExecutor, Name) {
+    using hastings::CameraNode;
+    using hastings::PerCameraExecutor;
+
+    auto executor = PerCameraExecutor(std::make_unique<CameraNode>());
+    EXPECT_EQ(executor.name(), "PerCameraExecutor");
+}
+
+TEST(PerCameraExecutor, Process) {
+    using hastings::CameraNode;
+    using hastings::PerCameraExecutor;
+
+    auto executor = PerCameraExecutor(std::make_unique<CameraNode>());
+
+    const auto context = hastings::createMultiImageContext();
+    context->cameras("left");
+    context->cameras("right");
+    executor.process(*context);
+
+    EXPECT_EQ(context->cameras("left")->result<std::string>("camera"), "left");
+    EXPECT_EQ(context->cameras("right")->result<std::string>("camera"), "right");
+}
+
+TEST(PerCameraExecutor, Schedule) {
+    using hastings::CameraNode;
+    using hastings::PerCameraExecutor;
+
+    auto executor = PerCameraExecutor(std::make_unique<CameraNode>());
+
+    const auto num_cameras = 12;
+    const auto context = hastings::createMultiImageContext();
+    for (auto idx = 0; idx < num_cameras; ++idx) {
+        context->cameras(std::to_string(idx));
+    }
+
+    std::atomic<int> num_continuations = 0;
+    auto num_processed = 0;
+    {
+        hastings::Scheduler scheduler(4);
+        scheduler.submit([&] {
+            executor.schedule(*context, scheduler, [&] {
+                // NOTE(will): the continuation runs once every camera has been processed.
+                for (const auto& [camera, camera_context, camera_id] : context->cameras()) {
+                    num_processed += camera_context->result<std::string>("camera") == camera;
+                }
+                num_continuations += 1;
+            });
+        });
+    }
+
+    EXPECT_EQ(num_continuations, 1);
+    EXPECT_EQ(num_processed, num_cameras);
+
+    const auto stats = executor.stats();
+    EXPECT_EQ(stats.name, "CameraNode");
+    EXPECT_EQ(stats.run.count, 1);
+}
+
+TEST(CameraOrderedExecutor, Constructor) {
+    using hastings::CameraOrderedExecutor;
+    using hastings::CameraStateNode;
+
+    EXPECT_NO_THROW(CameraOrderedExecutor(std::make_unique<CameraStateNode>()));
+}
+
+TEST(CameraOrderedExecutor, ConstructorBadNode) {
+    using hastings::CameraNode;
+    using hastings::CameraOrderedExecutor;
+    using hastings::OrderedNode;
+
+    EXPECT_THROW(CameraOrderedExecutor(std::make_unique<OrderedNode>()), std::invalid_argument);
+    EXPECT_THROW(CameraOrderedExecutor(std::make_unique<CameraNode>()), std::invalid_argument);
+}
+
+TEST(CameraOrderedExecutor, Name) {
+    using hastings::CameraOrderedExecutor;
+    using hastings::CameraStateNode;
+
+    auto executor = CameraOrderedExecutor(std::make_unique<CameraStateNode>());
+    EXPECT_EQ(executor.name(), "CameraOrderedExecutor");
+}
+
+TEST(CameraOrderedExecutor, Schedule) {
+    using hastings::CameraOrderedExecutor;
+    using hastings::CameraStateNode;
+
+    auto executor = CameraOrderedExecutor(std::make_unique<CameraStateNode>());
+
+    const auto num_frames = 100;
+    const std::vector<std::string> camera_names = {"left", "right", "rear"};
+
+    std::vector<hastings::MultiImageContextInterface::Ptr> contexts;
+    std::atomic<int> num_continuations = 0;
+    {
+        hastings::Scheduler scheduler(8);
+        for (auto idx = num_frames - 1; idx >= 0; --idx) {
+            auto& context = contexts.emplace_back(hastings::createMultiImageContext());
+            context->frameId(idx);
+            for (const auto& camera : camera_names) {
+                context->cameras(camera)->frameId(idx);
+            }
+
+            scheduler.submit([&, context = context.get()] {
+                executor.schedule(*context, scheduler, [&num_continuations] { num_continuations += 1; });
+            });
+        }
+    }
+
+    EXPECT_EQ(num_continuations, num_frames);
+
+    std::vector<int> expected_ordering(num_frames);
+    std::iota(expected_ordering.begin(), expected_ordering.end(), 0);
+
+    // NOTE(will): contexts were created newest first, so the front context holds the last frame.
+    for (const auto& camera : camera_names) {
+        const auto& ordering = contexts.front()->cameras(camera)->result<std::vector<int>>("frameOrdering");
+        EXPECT_THAT(ordering, testing::ElementsAreArray(expected_ordering));
+    }
+}
+
+TEST(CameraOrderedExecutor, CamerasRunConcurrently) {
+    using hastings::CameraOrderedExecutor;
+    using hastings::CameraStateNodeInterface;
+    using hastings::ImageContextInterface;
+
+    // NOTE(will): the left camera's first frame waits on the right camera's second frame, which deadlocks if the cameras share
+    // one ordering domain.
+    struct RendezvousNode final : CameraStateNodeInterface<int> {
+        std::string name() const override final { return "RendezvousNode"; }
+
+        void processCamera(const std::string& camera, ImageContextInterface& context, int& state) override final {
+            if (camera == "left" && context.frameId() == 0) {
+                const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+                while (!right_done && std::chrono::steady_clock::now() < deadline) {
+                    std::this_thread::yield();
+                }
+            } else if (camera == "right" && context.frameId() == 1) {
+                right_done = true;
+            }
+        }
+
+        std::atomic<bool> right_done = false;
+    };
+
+    auto node = std::make_unique<RendezvousNode>();
+    const auto& right_done = node->right_done;
+    auto executor = CameraOrderedExecutor(std::move(node));
+
+    std::vector<hastings::MultiImageContextInterface::Ptr> contexts;
+    {
+        hastings::Scheduler scheduler(4);
+        for (auto idx = 0; idx < 2; ++idx) {
+            auto& context = contexts.emplace_back(hastings::createMultiImageContext());
+            context->frameId(idx);
+            context->cameras("left")->frameId(idx);
+            context->cameras("right")->frameId(idx);
+
+            scheduler.submit([&, context = context.get()] { executor.schedule(*context, scheduler, [] {}); });
+        }
+    }
+
+    EXPECT_TRUE(right_done);
+}
+
+TEST(AsyncExecutor, Constructor) {
+    using hastings::AsyncExecutor;
+    using hastings::AsyncNode;
+    using hastings::ExecutionPolicy;
+
+    EXPECT_NO_THROW(AsyncExecutor(std::make_unique<AsyncNode>(ExecutionPolicy::Ordered)));
+    EXPECT_NO_THROW(AsyncExecutor(std::make_unique<AsyncNode>(ExecutionPolicy::Unordered)));
+    EXPECT_NO_THROW(AsyncExecutor(std::make_unique<AsyncNode>(ExecutionPolicy::Parallel)));
+}
+
+TEST(AsyncExecutor, ConstructorBadNode) {
+    using hastings::AsyncExecutor;
+    using hastings::AsyncNode;
+    using hastings::ExecutionPolicy;
+    using hastings::OrderedNode;
+
+    EXPECT_THROW(AsyncExecutor(std::make_unique<OrderedNode>()), std::invalid_argument);
+    EXPECT_THROW(AsyncExecutor(std::make_unique<AsyncNode>(ExecutionPolicy::Batched)), std::invalid_argument);
+}
+
+TEST(AsyncExecutor, Name) {
+    using hastings::AsyncNode;
+    using hastings::createExecutor;
+    using hastings::ExecutionPolicy;
+
+    const auto executor = createExecutor(std::make_unique<AsyncNode>(ExecutionPolicy::Ordered));
+    EXPECT_EQ(executor->name(), "AsyncExecutor");
+}
+
+TEST(AsyncExecutor, Process) {
+    using hastings::AsyncExecutor;
+    using hastings::AsyncNode;
+    using hastings::ExecutionPolicy;
+
+    auto executor = AsyncExecutor(std::make_unique<AsyncNode>(ExecutionPolicy::Ordered));
+
+    const auto num_threads = 20;
+    const auto frame_ordering = process(num_threads, &executor);
+
+    std::vector<int> expected_ordering(num_threads);
+    std::iota(expected_ordering.begin(), expected_ordering.end(), 0);
+
+    ASSERT_EQ(frame_ordering.size(), num_threads);
+    EXPECT_THAT(frame_ordering.back(), testing::ElementsAreArray(expected_ordering));
+}
+
+TEST(AsyncExecutor, ScheduleOrdered) {
+    using hastings::AsyncExecutor;
+    using hastings::AsyncNode;
+    using hastings::ExecutionPolicy;
+
+    auto executor = AsyncExecutor(std::make_unique<AsyncNode>(ExecutionPolicy::Ordered));
+
+    const auto num_frames = 100;
+    const auto frame_ordering = schedule(num_frames, &executor);
+
+    std::vector<int> expected_ordering(num_frames);
+    std::iota(expected_ordering.begin(), expected_ordering.end(), 0);
+
+    ASSERT_EQ(frame_ordering.size(), num_frames);
+
+    const auto& last = *std::max_element(frame_ordering.begin(), frame_ordering.end(),
+                                         [](const auto& lhs, const auto& rhs) { return lhs.size() < rhs.size(); });
+    EXPECT_THAT(last, testing::ElementsAreArray(expected_ordering));
+}
+
+TEST(AsyncExecutor, ScheduleUnordered) {
+    using hastings::AsyncExecutor;
+    using hastings::AsyncNode;
+    using hastings::ExecutionPolicy;
+
+    auto executor = AsyncExecutor(std::make_unique<AsyncNode>(ExecutionPolicy::Unordered));
+
+    const auto num_frames = 100;
+    const auto frame_ordering = schedule(num_frames, &executor);
+
+    std::vector<int> expected_ordering(num_frames);
+    std::iota(expected_ordering.begin(), expected_ordering.end(), 0);
+
+    ASSERT_EQ(frame_ordering.size(), num_frames);
+
+    const auto& last = *std::max_element(frame_ordering.begin(), frame_ordering.end(),
+                                         [](const auto& lhs, const auto& rhs) { return lhs.size() < rhs.size(); });
+    EXPECT_THAT(last, testing::UnorderedElementsAreArray(expected_ordering));
+}
+
+TEST(AsyncExecutor, ReleasesWorker) {
+    using hastings::AsyncExecutor;
+    using hastings::AsyncNodeInterface;
+    using hastings::ExecutionPolicy;
+    using hastings::MultiImageContextInterface;
+
+    // NOTE(will): the frame only completes once a later task on the single worker calls done, so a blocking node deadlocks.
+    struct PendingNode final : AsyncNodeInterface {
+        ExecutionPolicy executionPolicy() const override final { return ExecutionPolicy::Parallel; }
+        std::string name() const override final { return "PendingNode"; }
+
+        void processAsync(MultiImageContextInterface& multi_context, FnDone&& done) override final { pending = std::move(done); }
+
+        FnDone pending;
+    };
+
+    auto node = std::make_unique<PendingNode>();
+    auto& pending = node->pending;
+    auto executor = AsyncExecutor(std::move(node));
+
+    const auto context = hastings::createMultiImageContext();
+    auto completed = false;
+    {
+        hastings::Scheduler scheduler(1);
+        scheduler.submit([&] {
+            executor.schedule(*context, scheduler, [&completed] { completed = true; });
+            scheduler.submit([&pending] { pending(); });
+        });
+    }
+
+    EXPECT_TRUE(completed);
+}
+
+TEST(AsyncExecutor, ProcessExcludesSchedule) {
+    using hastings::AsyncExecutor;
+    using hastings::AsyncNodeInterface;
+    using hastings::ExecutionPolicy;
+    using hastings::MultiImageContextInterface;
+
+    struct ExclusiveNode final : AsyncNodeInterface {
+        ExecutionPolicy executionPolicy() const override final { return ExecutionPolicy::Unordered; }
+        std::string name() const override final { return "ExclusiveNode"; }
+
+        void processAsync(MultiImageContextInterface& multi_context, FnDone&& done) override final {
+            if (++num_active > 1) {
+                overlapped = true;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            --num_active;
+            done();
+        }
+
+        std::atomic<int> num_active{0};
+        std::atomic<bool> overlapped{false};
+    };
+
+    auto node = std::make_unique<ExclusiveNode>();
+    auto& overlapped = node->overlapped;
+    auto executor = AsyncExecutor(std::move(node));
+
+    // NOTE(will): blocking and scheduled frames share the executor, neither may run alongside the other.
+    const auto num_frames = 32;
+    std::vector<std::unique_ptr<MultiImageContextInterface>> contexts;
+    for (auto i = 0; i < 2 * num_frames; ++i) {
+        contexts.push_back(hastings::createMultiImageContext());
+    }
+
+    std::atomic<int> num_completed{0};
+    {
+        hastings::Scheduler scheduler(4);
+        std::thread blocking([&] {
+            for (auto i = 0; i < num_frames; ++i) {
+                executor.process(*contexts[i]);
+            }
+        });
+        for (auto i = num_frames; i < 2 * num_frames; ++i) {
+            scheduler.submit([&, i] { executor.schedule(*contexts[i], scheduler, [&num_completed] { ++num_completed; }); });
+        }
+        blocking.join();
+    }
+
+    EXPECT_EQ(num_completed, num_frames);
+    EXPECT_FALSE(overlapped);
+}
+
+namespace {
+// NOTE(will): fails the test if a replica is ever entered by two frames at once, tracks how many replicas ran concurrently.
+struct ReplicaNode final : hastings::NodeInterface {
+    explicit ReplicaNode(std::atomic<int>& num_active, std::atomic<int>& max_active) : num_active_(num_active), max_active_(max_active) {}
+
+    hastings::ExecutionPolicy executionPolicy() const override final { return hastings::ExecutionPolicy::Unordered; }
+    std::string name() const override final { return "ReplicaNode"; }
+
+    void process(hastings::MultiImageContextInterface& multi_context) override final {
+        EXPECT_FALSE(busy_.exchange(true));
+
+        const auto num_active = ++num_active_;
+        auto max_active = max_active_.load();
+        while (num_active > max_active && !max_active_.compare_exchange_weak(max_active, num_active)) {
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        multi_context.result("frameOrdering") = std::vector<int>{};
+
+        num_active_ -= 1;
+        busy_ = false;
+    }
+
+    std::atomic<bool> busy_ = false;
+    std::atomic<int>& num_active_;
+    std::atomic<int>& max_active_;
+};
+
+hastings::ReplicatedExecutor::Replicas replicas(const std::size_t num_replicas, std::atomic<int>& num_active,
+                                                std::atomic<int>& max_active) {
+    hastings::ReplicatedExecutor::Replicas replicas;
+    for (auto idx = std::size_t(0); idx < num_replicas; ++idx) {
+        replicas.emplace_back(std::make_unique<ReplicaNode>(num_active, max_active));
+    }
+    return replicas;
+}
+}  // namespace
+
+TEST(ReplicatedExecutor, Constructor) {
+    using hastings::ReplicatedExecutor;
+
+    std::atomic<int> num_active = 0;
+    std::atomic<int> max_active = 0;
+    EXPECT_NO_THROW(ReplicatedExecutor(replicas(1, num_active, max_active)));
+    EXPECT_NO_THROW(ReplicatedExecutor(replicas(64, num_active, max_active)));
+}
+
+TEST(ReplicatedExecutor, ConstructorBadNode) {
+    using hastings::OrderedNode;
+    using hastings::ReplicatedExecutor;
+
+    std::atomic<int> num_active = 0;
+    std::atomic<int> max_active = 0;
+    EXPECT_THROW(ReplicatedExecutor(replicas(0, num_active, max_active)), std::invalid_argument);
+    EXPECT_THROW(ReplicatedExecutor(replicas(65, num_active, max_active)), std::invalid_argument);
+
+    ReplicatedExecutor::Replicas ordered;
+    ordered.emplace_back(std::make_unique<OrderedNode>());
+    EXPECT_THROW(ReplicatedExecutor(std::move(ordered)), std::invalid_argument);
+}
+
+TEST(ReplicatedExecutor, Name) {
+    using hastings::ReplicatedExecutor;
+
+    std::atomic<int> num_active = 0;
+    std::atomic<int> max_active = 0;
+    auto executor = ReplicatedExecutor(replicas(2, num_active, max_active));
+    EXPECT_EQ(executor.name(), "ReplicatedExecutor");
+    EXPECT_EQ(executor.stats().name, "ReplicaNode");
+}
+
+TEST(ReplicatedExecutor, Process) {
+    using hastings::ReplicatedExecutor;
+
+    std::atomic<int> num_active = 0;
+    std::atomic<int> max_active = 0;
+    auto executor = ReplicatedExecutor(replicas(4, num_active, max_active));
+
+    const auto num_threads = 32;
+    const auto frame_ordering = process(num_threads, &executor);
+
+    EXPECT_EQ(frame_ordering.size(), num_threads);
+    EXPECT_LE(max_active, 4);
+    EXPECT_EQ(executor.stats().run.count, num_threads);
+}
+
+TEST(ReplicatedExecutor, Schedule) {
+    using hastings::ReplicatedExecutor;
+
+    std::atomic<int> num_active = 0;
+    std::atomic<int> max_active = 0;
+    auto executor = ReplicatedExecutor(replicas(4, num_active, max_active));
+
+    const auto num_frames = 100;
+    const auto frame_ordering = schedule(num_frames, &executor);
+
+    EXPECT_EQ(frame_ordering.size(), num_frames);
+    EXPECT_LE(max_active, 4);
+    EXPECT_EQ(executor.stats().wait.count, num_frames);
+}
+
+TEST(ReplicatedExecutor, ProcessWaitsOnSchedule) {
+    using hastings::MultiImageContextInterface;
+    using hastings::ReplicatedExecutor;
+
+    std::atomic<int> num_active = 0;
+    std::atomic<int> max_active = 0;
+    auto executor = ReplicatedExecutor(replicas(2, num_active, max_active));
+
+    // NOTE(will): blocked process() calls are woken by replicas released from scheduled frames as well as from each other.
+    const auto num_frames = 32;
+    std::vector<std::unique_ptr<MultiImageContextInterface>> contexts;
+    for (auto i = 0; i < 2 * num_frames; ++i) {
+        contexts.push_back(hastings::createMultiImageContext());
+    }
+
+    std::atomic<int> num_completed{0};
+    {
+        hastings::Scheduler scheduler(4);
+        std::vector<std::thread> threads;
+        for (auto i = 0; i < num_frames; ++i) {
+            threads.emplace_back([&executor, &contexts, i] { executor.process(*contexts[i]); });
+        }
+        for (auto i = num_frames; i < 2 * num_frames; ++i) {
+            scheduler.submit([&, i] { executor.schedule(*contexts[i], scheduler, [&num_completed] { ++num_completed; }); });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    EXPECT_EQ(num_completed, num_frames);
+    EXPECT_LE(max_active, 2);
+    EXPECT_EQ(executor.stats().run.count, 2 * num_frames);
+}
+
+TEST(BatchingExecutor, Constructor) {
+    using hastings::BatchingExecutor;
+    using hastings::BatchNode;
+
+    EXPECT_NO_THROW(BatchingExecutor(std::make_unique<BatchNode>(4, std::chrono::milliseconds(1))));
+}
+
+TEST(BatchingExecutor, ConstructorBadNode) {
+    using hastings::BatchingExecutor;
+    using hastings::BatchNode;
+    using hastings::OrderedNode;
+
+    EXPECT_THROW(BatchingExecutor(std::make_unique<OrderedNode>()), std::invalid_argument);
+    EXPECT_THROW(BatchingExecutor(std::make_unique<BatchNode>(0, std::chrono::milliseconds(1))), std::invalid_argument);
+}
+
+TEST(BatchingExecutor, Name) {
+    using hastings::BatchingExecutor;
+    using hastings::BatchNode;
+
+    auto executor = BatchingExecutor(std::make_unique<BatchNode>(4, std::chrono::milliseconds(1)));
+    EXPECT_EQ(executor.name(), "BatchingExecutor");
+}
+
+TEST(BatchingExecutor, Process) {
+    using hastings::BatchingExecutor;
+    using hastings::BatchNode;
+
+    auto executor = BatchingExecutor(std::make_unique<BatchNode>(4, std::chrono::seconds(10)));
+
+    const auto num_threads = 8;
+    const auto frame_ordering = process(num_threads, &executor);
+
+    ASSERT_EQ(frame_ordering.size(), num_threads);
+
+    const auto& last = *std::max_element(frame_ordering.begin(), frame_ordering.end(),
+                                         [](const auto& lhs, const auto& rhs) { return lhs.size() < rhs.size(); });
+    ASSERT_EQ(last.size(), num_threads);
+
+    // NOTE(will): frames within each batch are handed to the node sorted by frame id.
+    EXPECT_TRUE(std::is_sorted(last.begin(), last.begin() + 4));
+    EXPECT_TRUE(std::is_sorted(last.begin() + 4, last.end()));
+}
+
+TEST(BatchingExecutor, Timeout) {
+    using hastings::BatchingExecutor;
+    using hastings::BatchNode;
+
+    auto executor = BatchingExecutor(std::make_unique<BatchNode>(4, std::chrono::milliseconds(1)));
+
+    const auto context = hastings::createMultiImageContext();
+    executor.process(*context);
+
+    EXPECT_EQ(context->result<std::size_t>("batchSize"), 1);
+}
+
+TEST(BatchingExecutor, Schedule) {
+    using hastings::BatchingExecutor;
+    using hastings::BatchNode;
+
+    auto executor = BatchingExecutor(std::make_unique<BatchNode>(4, std::chrono::seconds(10)));
+
+    const auto num_frames = 100;
+    const auto frame_ordering = schedule(num_frames, &executor);
+
+    std::vector<int> expected_ordering(num_frames);
+    std::iota(expected_ordering.begin(), expected_ordering.end(), 0);
+
+    ASSERT_EQ(frame_ordering.size(), num_frames);
+
+    const auto& last = *std::max_element(frame_ordering.begin(), frame_ordering.end(),
+                                         [](const auto& lhs, const auto& rhs) { return lhs.size() < rhs.size(); });
+    EXPECT_THAT(last, testing::UnorderedElementsAreArray(expected_ordering));
+}
+
+TEST(BatchingExecutor, ScheduleReleasesWorker) {
+    using hastings::BatchingExecutor;
+    using hastings::BatchNode;
+
+    auto executor = BatchingExecutor(std::make_unique<BatchNode>(2, std::chrono::seconds(10)));
+
+    const auto first = hastings::createMultiImageContext();
+    const auto second = hastings::createMultiImageContext();
+    second->frameId(1);
+
+    // NOTE(will): with a single worker the second frame can only join the batch if scheduling the first didn't hold the worker.
+    std::atomic<int> num_completed = 0;
+    {
+        hastings::Scheduler scheduler(1);
+        scheduler.submit([&] {
+            executor.schedule(*first, scheduler, [&num_completed] { num_completed += 1; });
+            scheduler.submit([&] { executor.schedule(*second, scheduler, [&num_completed] { num_completed += 1; }); });
+        });
+
+        while (num_completed < 2) {
+            std::this_thread::yield();
+        }
+    }
+
+    EXPECT_EQ(first->result<std::size_t>("batchSize"), 2);
+    EXPECT_EQ(second->result<std::size_t>("batchSize"), 2);
+}
+
+TEST(BatchingExecutor, ScheduleWhileRunning) {
+    using hastings::BatchingExecutor;
+
+    struct BlockingBatchNode final : hastings::BatchNodeInterface {
+        BlockingBatchNode(std::shared_future<void> release, std::atomic<bool>& is_running)
+            : release_(std::move(release)), is_running_(is_running) {}
+
+        std::string name() const override final { return "BlockingBatchNode"; }
+        std::size_t batchSize() const override final { return 1; }
+        Duration batchTimeout() const override final { return std::chrono::seconds(10); }
+
+        void processBatch(const Batch& batch) override final {
+            if (batch.front()->frameId() == 0) {
+                is_running_ = true;
+                release_.wait();
+            }
+            batch.front()->result("processed") = true;
+        }
+
+        std::shared_future<void> release_;
+        std::atomic<bool>& is_running_;
+    };
+
+    std::promise<void> release;
+    std::atomic<bool> is_running = false;
+    auto executor = BatchingExecutor(std::make_unique<BlockingBatchNode>(release.get_future().share(), is_running));
+
+    const auto first = hastings::createMultiImageContext();
+    const auto second = hastings::createMultiImageContext();
+    second->frameId(1);
+
+    // NOTE(will): the second batch fills while the first is running, it's queued for the first one's worker instead of holding its own
+    std::atomic<int> num_completed = 0;
+    std::atomic<bool> is_scheduled = false;
+    {
+        hastings::Scheduler scheduler(2);
+        scheduler.submit([&] { executor.schedule(*first, scheduler, [&num_completed] { num_completed += 1; }); });
+        while (!is_running) {
+            std::this_thread::yield();
+        }
+
+        scheduler.submit([&] {
+            executor.schedule(*second, scheduler, [&num_completed] { num_completed += 1; });
+            is_scheduled = true;
+        });
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!is_scheduled && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        EXPECT_TRUE(is_scheduled);
+
+        release.set_value();
+        while (num_completed < 2) {
+            std::this_thread::yield();
+        }
+    }
+
+    EXPECT_TRUE(second->result<bool>("processed"));
+}
+
+TEST(BatchingExecutor, ScheduleTimeout) {
+    using hastings::BatchingExecutor;
+    using hastings::BatchNode;
+
+    auto executor = BatchingExecutor(std::make_unique<BatchNode>(4, std::chrono::milliseconds(1)));
+
+    const auto context = hastings::createMultiImageContext();
+    std::atomic<bool> completed = false;
+    {
+        hastings::Scheduler scheduler(1);
+        scheduler.submit([&] { executor.schedule(*context, scheduler, [&completed] { completed = true; }); });
+
+        while (!completed) {
+            std::this_thread::yield();
+        }
+    }
+
+    EXPECT_EQ(context->result<std::size_t>("batchSize"), 1);
+}
+
+TEST(BatchingExecutor, Stats) {
+    using hastings::BatchingExecutor;
+    using hastings::BatchNode;
+
+    auto executor = BatchingExecutor(std::make_unique<BatchNode>(4, std::chrono::seconds(10)));
+    process(8, &executor);
+
+    const auto stats = executor.stats();
+    EXPECT_EQ(stats.name, "BatchNode");
+    EXPECT_EQ(stats.run.count, 2);
+    EXPECT_EQ(stats.wait.count, 8);
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <hastings/pipeline/context.h>
+#include <hastings/pipeline/frame_arena.h>
+
+#include <cstdint>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+TEST(FrameArena, Alignment) {
+    using hastings::FrameArena;
+
+    FrameArena arena(256);
+    for (const std::size_t alignment : {1, 2, 8, 16, 64}) {
+        const auto pointer = arena.allocate(3, alignment);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(pointer) % alignment, 0);
+    }
+}
+
+TEST(FrameArena, Reset) {
+    using hastings::FrameArena;
+
+    FrameArena arena(256);
+    const auto first = arena.allocate(64);
+    arena.allocate(64);
+
+    arena.reset();
+    EXPECT_EQ(arena.allocate(64), first);
+    EXPECT_EQ(arena.capacity(), 256);
+}
+
+TEST(FrameArena, Grow) {
+    using hastings::FrameArena;
+
+    FrameArena arena(256);
+    for (int i = 0; i < 10; ++i) {
+        arena.allocate(128);
+    }
+    EXPECT_GE(arena.capacity(), 1280);
+
+    // the blocks are merged into one, so the same frame fits without growing again
+    const auto capacity = arena.capacity();
+    arena.reset();
+    for (int i = 0; i < 10; ++i) {
+        arena.allocate(128);
+    }
+    EXPECT_EQ(arena.capacity(), capacity);
+}
+
+TEST(FrameArena, Large) {
+    using hastings::FrameArena;
+
+    FrameArena arena(256);
+    const auto pointer = static_cast<char*>(arena.allocate(4096));
+    pointer[4095] = 1;
+    EXPECT_GE(arena.capacity(), 4096);
+}
+
+TEST(FrameArena, Threads) {
+    using hastings::FrameArena;
+
+    FrameArena arena(1024);
+
+    constexpr int num_threads = 4;
+    constexpr int num_allocations = 1000;
+
+    std::vector<std::vector<std::uint64_t*>> pointers(num_threads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&arena, &pointers, t] {
+            for (int i = 0; i < num_allocations; ++i) {
+                const auto pointer = static_cast<std::uint64_t*>(arena.allocate(sizeof(std::uint64_t), alignof(std::uint64_t)));
+                *pointer = t * num_allocations + i;
+                pointers[t].push_back(pointer);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int t = 0; t < num_threads; ++t) {
+        for (int i = 0; i < num_allocations; ++i) {
+            EXPECT_EQ(*pointers[t][i], t * num_allocations + i);
+        }
+    }
+}
+
+TEST(FrameArena, Vector) {
+    using hastings::FrameArena;
+
+    FrameArena arena;
+    std::pmr::vector<int> values(&arena);
+    for (int i = 0; i < 1000; ++i) {
+        values.push_back(i);
+    }
+    EXPECT_EQ(values.back(), 999);
+    EXPECT_EQ(values.get_allocator().resource(), &arena);
+}
+
+TEST(FrameArena, ContextGraphics) {
+    using hastings::createMultiImageContext;
+    using hastings::LineGraphic;
+    using hastings::VectorGraphics;
+
+    const auto context = createMultiImageContext();
+    context->image("BGR");
+
+    VectorGraphics graphics(&context->arena());
+    graphics.emplace_back(LineGraphic{{0, 255, 0}, {0, 0}, {10, 10}});
+    context->vectorGraphic("BGR", std::move(graphics));
+
+    const auto& stored = context->vectorGraphic("BGR");
+    EXPECT_EQ(stored.size(), 1);
+    EXPECT_EQ(stored.get_allocator().resource(), &context->arena());
+
+    context->clear();
+    EXPECT_TRUE(context->vectorGraphic("BGR").empty());
+}
+
+TEST(FrameArena, ContextTypedResult) {
+    using hastings::createImageContext;
+    using hastings::ResultKey;
+
+    const auto context = createImageContext();
+    const ResultKey<std::pmr::vector<int>> key("FrameArena.ContextTypedResult");
+
+    auto& values = context->result(key);
+    EXPECT_EQ(values.get_allocator().resource(), &context->arena());
+    values.assign(100, 1);
+
+    context->clear();
+    EXPECT_TRUE(context->result(key).empty());
+    EXPECT_EQ(context->result(key).get_allocator().resource(), &context->arena());
+
+    context->result(key).assign(100, 2);
+    EXPECT_EQ(context->result(key).back(), 2);
+}
@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+#include <hastings/pipeline/context.h>
+#include <hastings/pipeline/frame_history.h>
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace {
+std::unique_ptr<hastings::MultiImageContextInterface> createFrame(const std::size_t frame_id, const float value) {
+    auto context = hastings::createMultiImageContext();
+    context->frameId(frame_id);
+    context->image("BGR") = cv::Mat::zeros(1, 1, CV_32FC1);
+    context->image("BGR").at<float>(0, 0) = value;
+    return context;
+}
+}  // namespace
+
+TEST(FrameHistory, NotRetained) {
+    using hastings::FrameHistory;
+    using hastings::Key;
+
+    FrameHistory history;
+    const auto frame = createFrame(0, 1.0f);
+    history.record(*frame, Key("BGR"));
+
+    EXPECT_TRUE(history.image(FrameHistory::frame_index, Key("BGR"), 0).empty());
+}
+
+TEST(FrameHistory, Record) {
+    using hastings::FrameHistory;
+    using hastings::Key;
+
+    FrameHistory history;
+    history.retain(Key("BGR"), 2);
+
+    const auto frame = createFrame(7, 1.0f);
+    history.record(*frame, Key("BGR"));
+
+    const auto image = history.image(FrameHistory::frame_index, Key("BGR"), 7);
+    ASSERT_FALSE(image.empty());
+    EXPECT_EQ(image.data, frame->view(Key("BGR")).data);
+    EXPECT_TRUE(history.image(FrameHistory::frame_index, Key("BGR"), 5).empty());
+}
+
+TEST(FrameHistory, Cameras) {
+    using hastings::CameraId;
+    using hastings::FrameHistory;
+    using hastings::Key;
+
+    FrameHistory history;
+    history.retain(Key("BGR"), 2);
+
+    const CameraId camera("camera_a");
+    const auto frame = hastings::createMultiImageContext();
+    frame->history(&history);
+    frame->frameId(3);
+    frame->cameras(camera)->image(Key("BGR")) = cv::Mat::zeros(1, 1, CV_32FC1);
+    history.record(*frame, Key("BGR"));
+
+    EXPECT_FALSE(history.image(camera.id() + 1, Key("BGR"), 3).empty());
+    EXPECT_TRUE(history.image(FrameHistory::frame_index, Key("BGR"), 3).empty());
+
+    frame->frameId(4);
+    EXPECT_FALSE(frame->cameras(camera)->history(Key("BGR"), 1).empty());
+    EXPECT_TRUE(frame->history(Key("BGR"), 1).empty());
+}
+
+TEST(FrameHistory, Bytes) {
+    using hastings::FrameHistory;
+    using hastings::Key;
+
+    FrameHistory history;
+    history.retain(Key("BGR"), 2);
+
+    auto frame = createFrame(0, 1.0f);
+    history.record(*frame, Key("BGR"));
+    EXPECT_EQ(history.bytes(), 0);
+
+    // NOTE(will): once the frame lets go of its image only the history holds it, so the history counts it.
+    frame.reset();
+    EXPECT_EQ(history.bytes(), sizeof(float));
+}
+
+TEST(FrameHistory, Recorders) {
+    using hastings::Dependencies;
+    using hastings::FrameHistory;
+    using hastings::Key;
+
+    const std::vector<std::optional<Dependencies>> dependencies{
+        Dependencies{{}, {"Y"}},
+        std::nullopt,
+        Dependencies{{}, {"BGR"}},
+        Dependencies{{"BGR"}, {"BGR", "flow"}},
+    };
+    const auto recorders = FrameHistory::recorders({Key("BGR"), Key("Y"), Key("flow"), Key("diff")}, dependencies);
+
+    // NOTE(will): the node without declarations may write Y after its last declared writer, nothing declares diff
+    ASSERT_EQ(recorders.nodes.size(), 4);
+    EXPECT_TRUE(recorders.nodes[0].empty());
+    EXPECT_TRUE(recorders.nodes[1].empty());
+    EXPECT_TRUE(recorders.nodes[2].empty());
+    EXPECT_EQ(recorders.nodes[3], (std::vector<Key>{Key("BGR"), Key("flow")}));
+    EXPECT_EQ(recorders.frame, (std::vector<Key>{Key("Y"), Key("diff")}));
+}
+
+TEST(FrameHistory, Eviction) {
+    using hastings::FrameHistory;
+    using hastings::Key;
+
+    FrameHistory history;
+    history.retain(Key("BGR"), 2);
+
+    // NOTE(will): frame 3 reads back to frame 1, frame 0 isn't needed anymore
+    for (auto frame_id = 0u; frame_id < 4; ++frame_id) {
+        history.record(*createFrame(frame_id, float(frame_id)), Key("BGR"));
+    }
+
+    EXPECT_TRUE(history.image(FrameHistory::frame_index, Key("BGR"), 0).empty());
+    EXPECT_EQ(history.image(FrameHistory::frame_index, Key("BGR"), 1).at<float>(0, 0), 1.0f);
+    EXPECT_EQ(history.image(FrameHistory::frame_index, Key("BGR"), 3).at<float>(0, 0), 3.0f);
+}
+
+TEST(FrameHistory, RetainOne) {
+    using hastings::FrameHistory;
+    using hastings::Key;
+
+    FrameHistory history;
+    history.retain(Key("BGR"), 1);
+
+    // NOTE(will): recording a frame keeps the one before it for its readers
+    history.record(*createFrame(0, 0.0f), Key("BGR"));
+    history.record(*createFrame(1, 1.0f), Key("BGR"));
+
+    EXPECT_EQ(history.image(FrameHistory::frame_index, Key("BGR"), 0).at<float>(0, 0), 0.0f);
+    EXPECT_EQ(history.image(FrameHistory::frame_index, Key("BGR"), 1).at<float>(0, 0), 1.0f);
+}
+
+TEST(FrameHistory, InFlight) {
+    using hastings::FrameHistory;
+    using hastings::Key;
+
+    FrameHistory history;
+    history.retain(Key("BGR"), 2);
+    history.inFlight(3);
+
+    // NOTE(will): frame 1 is kept for a frame 3 still running behind the writer of frame 5
+    for (auto frame_id = 0u; frame_id < 6; ++frame_id) {
+        history.record(*createFrame(frame_id, float(frame_id)), Key("BGR"));
+    }
+
+    EXPECT_TRUE(history.image(FrameHistory::frame_index, Key("BGR"), 0).empty());
+    EXPECT_EQ(history.image(FrameHistory::frame_index, Key("BGR"), 1).at<float>(0, 0), 1.0f);
+    EXPECT_EQ(history.image(FrameHistory::frame_index, Key("BGR"), 5).at<float>(0, 0), 5.0f);
+}
+
+TEST(FrameHistory, OutOfOrder) {
+    using hastings::FrameHistory;
+    using hastings::Key;
+
+    FrameHistory history;
+    history.retain(Key("BGR"), 2);
+
+    history.record(*createFrame(4, 4.0f), Key("BGR"));
+    history.record(*createFrame(1, 1.0f), Key("BGR"));
+
+    EXPECT_TRUE(history.image(FrameHistory::frame_index, Key("BGR"), 1).empty());
+    EXPECT_EQ(history.image(FrameHistory::frame_index, Key("BGR"), 4).at<float>(0, 0), 4.0f);
+}
+
+TEST(FrameHistory, Release) {
+    using hastings::FrameHistory;
+    using hastings::Key;
+
+    FrameHistory history;
+    history.retain(Key("BGR"), 2);
+    history.record(*createFrame(0, 1.0f), Key("BGR"));
+
+    history.retain(Key("BGR"), 0);
+    EXPECT_TRUE(history.image(FrameHistory::frame_index, Key("BGR"), 0).empty());
+
+    history.record(*createFrame(1, 1.0f), Key("BGR"));
+    EXPECT_TRUE(history.image(FrameHistory::frame_index, Key("BGR"), 1).empty());
+}
+
+TEST(FrameHistory, WriteAfterRecord) {
+    using hastings::FrameHistory;
+    using hastings::Key;
+
+    FrameHistory history;
+    history.retain(Key("BGR"), 2);
+
+    const auto frame = createFrame(0, 1.0f);
+    history.record(*frame, Key("BGR"));
+
+    // NOTE(will): the recorded image is shared, writing to the frame's copies it first
+    frame->image(Key("BGR")).at<float>(0, 0) = 2.0f;
+    EXPECT_EQ(history.image(FrameHistory::frame_index, Key("BGR"), 0).at<float>(0, 0), 1.0f);
+    EXPECT_EQ(frame->view(Key("BGR")).at<float>(0, 0), 2.0f);
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <hastings/pipeline/key.h>
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(Key, SameName) {
+    using hastings::Key;
+
+    const Key key_a("key-test-a");
+    const Key key_b(std::string("key-test-a"));
+
+    EXPECT_EQ(key_a, key_b);
+    EXPECT_EQ(key_a.id(), key_b.id());
+    EXPECT_EQ(key_a.name(), "key-test-a");
+}
+
+TEST(Key, DifferentNames) {
+    using hastings::Key;
+
+    const Key key_a("key-test-a");
+    const Key key_b("key-test-b");
+
+    EXPECT_NE(key_a, key_b);
+    EXPECT_EQ(key_b.name(), "key-test-b");
+}
+
+TEST(Key, ConcurrentInterning) {
+    using hastings::Key;
+
+    const auto num_threads = 8;
+    std::vector<std::size_t> ids(num_threads);
+
+    std::vector<std::thread> threads;
+    for (auto idx = 0; idx < num_threads; ++idx) {
+        threads.emplace_back([&ids, idx] { ids[idx] = Key("key-test-concurrent").id(); });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (const auto id : ids) {
+        EXPECT_EQ(id, ids.front());
+    }
+}
+
+TEST(ResultKey, SameType) {
+    using hastings::ResultKey;
+
+    const ResultKey<std::vector<int>> key_a("key-test-typed");
+    const ResultKey<std::vector<int>> key_b("key-test-typed");
+
+    EXPECT_EQ(key_a.key(), key_b.key());
+    EXPECT_EQ(key_a.name(), "key-test-typed");
+}
+
+TEST(ResultKey, OtherType) {
+    using hastings::ResultKey;
+
+    const ResultKey<std::vector<int>> key("key-test-typed");
+    ASSERT_THROW({ ResultKey<std::string>("key-test-typed"); }, std::invalid_argument);
+}
+
+TEST(CameraId, SameName) {
+    using hastings::CameraId;
+
+    const CameraId camera_a("camera-test-a");
+    const CameraId camera_b("camera-test-a");
+    const CameraId camera_c("camera-test-c");
+
+    EXPECT_EQ(camera_a, camera_b);
+    EXPECT_NE(camera_a, camera_c);
+    EXPECT_EQ(camera_c.name(), "camera-test-c");
+    EXPECT_LT(camera_c.id(), CameraId::max_cameras);
+}
@@ -1,8 +1,18 @@
 #include <gtest/gtest.h>
+#include <hastings/pipeline/context.h>
 #include <hastings/pipeline/node.h>
 #include <hastings/pipeline/pipeline.h>
 
+#include <algorithm>
+#include <any>
+#include <atomic>
+#include <chrono>
 #include <functional>
+#include <future>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "helpers.h"
 
@@ -93,4 +103,701 @@ TEST(Pipeline, clears) {
         multi_context.result("a") = 12345;
         multi_context.result("b") = "helloWorld";
     });
-}
\ No newline at end of file
+}
+
+struct DeclaredNode final : hastings::NodeInterface {
+    using FnCallback = std::function<void(hastings::MultiImageContextInterface&)>;
+
+    DeclaredNode(hastings::Dependencies dependencies, FnCallback fn, hastings::ExecutionPolicy policy = hastings::ExecutionPolicy::Parallel)
+        : dependencies_(std::move(dependencies)), fn_(std::move(fn)), policy_(policy) {}
+
+    hastings::ExecutionPolicy executionPolicy() const override final { return policy_; }
+    std::string name() const override final { return "DeclaredNode"; }
+    std::optional<hastings::Dependencies> dependencies() const override final { return dependencies_; }
+
+    void process(hastings::MultiImageContextInterface& multi_context) override final { fn_(multi_context); }
+
+    hastings::Dependencies dependencies_;
+    FnCallback fn_;
+    hastings::ExecutionPolicy policy_;
+};
+
+TEST(Pipeline, independentNodesOverlap) {
+    using hastings::createPipeline;
+    using hastings::MultiImageContextInterface;
+
+    std::atomic<int> num_started = 0;
+    std::atomic<int> num_overlapped = 0;
+
+    // NOTE(will): each node waits for the other to start, which only happens if they run at the same time.
+    const auto rendezvous = [&](MultiImageContextInterface& multi_context) {
+        num_started += 1;
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (num_started != 2 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+
+        num_overlapped += num_started == 2;
+    };
+
+    const auto pipeline = createPipeline(2);
+    pipeline->add<DeclaredNode>(hastings::Dependencies{{"BGR"}, {"diff"}}, rendezvous);
+    pipeline->add<DeclaredNode>(hastings::Dependencies{{"BGR"}, {"Y"}}, rendezvous);
+    pipeline->start(1);
+
+    EXPECT_EQ(num_overlapped, 2);
+}
+
+TEST(Pipeline, dependentNodesInOrder) {
+    using hastings::createPipeline;
+    using hastings::MultiImageContextInterface;
+
+    std::atomic<int> num_checked = 0;
+
+    const auto pipeline = createPipeline(4);
+    pipeline->add<DeclaredNode>(hastings::Dependencies{{}, {"a"}}, [](MultiImageContextInterface& multi_context) {
+        multi_context.result("a") = int(multi_context.frameId());
+    });
+    pipeline->add<DeclaredNode>(hastings::Dependencies{{"c"}, {"b"}}, [](MultiImageContextInterface& multi_context) {
+        multi_context.result("b") = int(multi_context.frameId());
+    });
+    pipeline->add<DeclaredNode>(hastings::Dependencies{{"a"}, {}}, [&num_checked](MultiImageContextInterface& multi_context) {
+        ASSERT_EQ(multi_context.result<int>("a"), multi_context.frameId());
+        num_checked += 1;
+    });
+    pipeline->add<hastings::OrderedNode>();
+    pipeline->add<DeclaredNode>(hastings::Dependencies{{}, {"a"}}, [](MultiImageContextInterface& multi_context) {
+        ASSERT_TRUE(multi_context.result("frameOrdering").has_value());
+    });
+    pipeline->start(100);
+
+    EXPECT_EQ(num_checked, 100);
+}
+
+std::vector<std::size_t> testLatencyBudget(const hastings::DropPolicy policy) {
+    using hastings::createPipeline;
+    using hastings::ExecutionPolicy;
+    using hastings::MultiImageContextInterface;
+    using hastings::NodeInterface;
+    using FnCallback = std::function<void(MultiImageContextInterface&)>;
+
+    struct LambdaNode final : NodeInterface {
+        LambdaNode(ExecutionPolicy policy, FnCallback fn) : policy_(policy), fn_(fn) {}
+
+        ExecutionPolicy executionPolicy() const override final { return policy_; }
+        std::string name() const override final { return "LambdaNode"; }
+        void process(MultiImageContextInterface& multi_context) override final { fn_(multi_context); }
+
+        ExecutionPolicy policy_;
+        FnCallback fn_;
+    };
+
+    std::vector<std::size_t> frame_ids;
+
+    const auto pipeline = createPipeline(4);
+    pipeline->latencyBudget(std::chrono::milliseconds(50), policy);
+
+    pipeline->add<hastings::OrderedNode>();
+    pipeline->add<LambdaNode>(ExecutionPolicy::Parallel, [](MultiImageContextInterface& multi_context) {
+        if (multi_context.frameId() % 3 == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    });
+    pipeline->add<LambdaNode>(ExecutionPolicy::Ordered,
+                              [&frame_ids](MultiImageContextInterface& multi_context) { frame_ids.emplace_back(multi_context.frameId()); });
+    pipeline->start(30);
+
+    return frame_ids;
+}
+
+TEST(Pipeline, latencyBudgetDropOldest) {
+    const auto frame_ids = testLatencyBudget(hastings::DropPolicy::DropOldest);
+
+    EXPECT_FALSE(frame_ids.empty());
+    EXPECT_LT(frame_ids.size(), 30);
+    EXPECT_TRUE(std::is_sorted(frame_ids.begin(), frame_ids.end()));
+
+    for (const auto frame_id : frame_ids) {
+        EXPECT_NE(frame_id % 3, 0);
+    }
+}
+
+TEST(Pipeline, latencyBudgetSkipToLatest) {
+    const auto frame_ids = testLatencyBudget(hastings::DropPolicy::SkipToLatest);
+
+    EXPECT_LT(frame_ids.size(), 30);
+    EXPECT_TRUE(std::is_sorted(frame_ids.begin(), frame_ids.end()));
+
+    for (const auto frame_id : frame_ids) {
+        EXPECT_NE(frame_id % 3, 0);
+    }
+}
+
+TEST(Pipeline, latencyBudgetParkedFrames) {
+    using hastings::createPipeline;
+    using hastings::ExecutionPolicy;
+    using hastings::MultiImageContextInterface;
+
+    std::vector<std::size_t> frame_ids;
+
+    // NOTE(will): every frame reaches the slow ordered node well within the budget, the ones parked behind it blow the budget while
+    // they wait and have to be dropped when they're resumed.
+    const auto pipeline = createPipeline(4);
+    pipeline->latencyBudget(std::chrono::milliseconds(20), hastings::DropPolicy::DropOldest);
+    pipeline->add<DeclaredNode>(
+        hastings::Dependencies{{}, {"a"}},
+        [&frame_ids](MultiImageContextInterface& multi_context) {
+            frame_ids.emplace_back(multi_context.frameId());
+            std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        },
+        ExecutionPolicy::Ordered);
+    pipeline->start(20);
+
+    const auto stats = pipeline->stats();
+    EXPECT_FALSE(frame_ids.empty());
+    EXPECT_LT(frame_ids.size(), 20);
+    EXPECT_EQ(stats.num_dropped, 20 - frame_ids.size());
+    EXPECT_TRUE(std::is_sorted(frame_ids.begin(), frame_ids.end()));
+}
+
+TEST(Pipeline, stats) {
+    using hastings::createPipeline;
+
+    const auto pipeline = createPipeline(4);
+    pipeline->add<hastings::OrderedNode>();
+    pipeline->add<hastings::ParallelNode>();
+    pipeline->start(50);
+
+    const auto stats = pipeline->stats();
+    EXPECT_EQ(stats.num_frames, 50);
+    EXPECT_EQ(stats.num_dropped, 0);
+    EXPECT_EQ(stats.frame.count, 50);
+
+    ASSERT_EQ(stats.nodes.size(), 2);
+    EXPECT_EQ(stats.nodes[0].name, "OrderedNode");
+    EXPECT_EQ(stats.nodes[0].run.count, 50);
+    EXPECT_EQ(stats.nodes[0].wait.count, 50);
+    EXPECT_EQ(stats.nodes[1].name, "ParallelNode");
+    EXPECT_EQ(stats.nodes[1].run.count, 50);
+}
+
+TEST(Pipeline, batched) {
+    using hastings::BatchNode;
+    using hastings::createPipeline;
+
+    const auto pipeline = createPipeline(4);
+    pipeline->add<BatchNode>(4, std::chrono::milliseconds(1));
+    pipeline->start(100);
+
+    const auto stats = pipeline->stats();
+    EXPECT_EQ(stats.num_frames, 100);
+    ASSERT_EQ(stats.nodes.size(), 1);
+    EXPECT_EQ(stats.nodes[0].wait.count, 100);
+    EXPECT_LE(stats.nodes[0].run.count, 100);
+}
+
+TEST(Pipeline, replicated) {
+    using hastings::createPipeline;
+    using hastings::UnorderedNode;
+
+    auto num_built = 0;
+    const auto pipeline = createPipeline(4);
+    pipeline->add(
+        [&num_built] {
+            num_built += 1;
+            return std::make_unique<UnorderedNode>();
+        },
+        3);
+    pipeline->addReplicated<UnorderedNode>(2);
+    pipeline->start(100);
+
+    EXPECT_EQ(num_built, 3);
+
+    const auto stats = pipeline->stats();
+    EXPECT_EQ(stats.num_frames, 100);
+    ASSERT_EQ(stats.nodes.size(), 2);
+    EXPECT_EQ(stats.nodes[0].name, "UnorderedNode");
+    EXPECT_EQ(stats.nodes[0].run.count, 100);
+}
+
+TEST(Pipeline, previousFrameInputs) {
+    using hastings::createPipeline;
+    using hastings::Dependencies;
+    using hastings::MultiImageContextInterface;
+
+    std::atomic<int> num_mismatched = 0;
+
+    // NOTE(will): a parallel node accumulating over its own previous output only stays consistent if frame N waits on frame N - 1.
+    const auto pipeline = createPipeline(4);
+    pipeline->add<DeclaredNode>(Dependencies{{}, {"id"}, {}},
+                                [](MultiImageContextInterface& multi_context) { multi_context.result("id") = multi_context.frameId(); });
+    pipeline->add<DeclaredNode>(Dependencies{{"id"}, {"sum"}, {"id", "sum"}}, [&](MultiImageContextInterface& multi_context) {
+        const auto previous = multi_context.previous();
+        if (previous == nullptr) {
+            num_mismatched += multi_context.frameId() != 0;
+            multi_context.result("sum") = std::size_t(0);
+            return;
+        }
+
+        num_mismatched += previous->result<std::size_t>("id") + 1 != multi_context.frameId();
+        multi_context.result("sum") = previous->result<std::size_t>("sum") + multi_context.result<std::size_t>("id");
+        num_mismatched += multi_context.result<std::size_t>("sum") != multi_context.frameId() * (multi_context.frameId() + 1) / 2;
+    });
+    pipeline->start(500);
+
+    EXPECT_EQ(num_mismatched, 0);
+    EXPECT_EQ(pipeline->stats().num_frames, 500);
+}
+
+TEST(Pipeline, previousFrameInputsSingleThread) {
+    using hastings::createPipeline;
+    using hastings::Dependencies;
+    using hastings::MultiImageContextInterface;
+
+    auto num_previous = 0;
+
+    const auto pipeline = createPipeline(1);
+    pipeline->add<DeclaredNode>(Dependencies{{}, {"id"}, {"id"}}, [&](MultiImageContextInterface& multi_context) {
+        const auto previous = multi_context.previous();
+        if (previous != nullptr) {
+            EXPECT_EQ(previous->result<std::size_t>("id") + 1, multi_context.frameId());
+            num_previous += 1;
+        }
+        multi_context.result("id") = multi_context.frameId();
+    });
+    pipeline->start(100);
+
+    EXPECT_EQ(num_previous, 99);
+}
+
+TEST(Pipeline, restart) {
+    using hastings::createPipeline;
+    using hastings::Dependencies;
+    using hastings::MultiImageContextInterface;
+
+    const auto pipeline = createPipeline(4);
+    pipeline->add<DeclaredNode>(Dependencies{{}, {"id"}}, [](MultiImageContextInterface& multi_context) {});
+    pipeline->add<hastings::OrderedNode>();
+    pipeline->start(50);
+    pipeline->start(50);
+
+    EXPECT_EQ(pipeline->stats().num_frames, 100);
+}
+
+TEST(Pipeline, stop) {
+    using hastings::createPipeline;
+    using hastings::MultiImageContextInterface;
+    using hastings::PipelineInterface;
+
+    // NOTE(will): the ordered node deadlocks on restart unless frame ids stay contiguous across the stop.
+    const auto pipeline = createPipeline(2);
+    PipelineInterface* running = pipeline.get();
+    pipeline->add<DeclaredNode>(hastings::Dependencies{{}, {}}, [&](MultiImageContextInterface& multi_context) {
+        if (multi_context.frameId() == 10) {
+            running->stop();
+        }
+    });
+    pipeline->add<hastings::OrderedNode>();
+    pipeline->start();
+
+    const auto num_stopped = pipeline->stats().num_frames;
+    EXPECT_GE(num_stopped, 11);
+
+    pipeline->start(20);
+    EXPECT_EQ(pipeline->stats().num_frames, num_stopped + 20);
+}
+
+TEST(Pipeline, stopBeforeStart) {
+    using hastings::createPipeline;
+
+    const auto pipeline = createPipeline(2);
+    pipeline->add<hastings::OrderedNode>();
+    pipeline->stop();
+    pipeline->start(50);
+    EXPECT_EQ(pipeline->stats().num_frames, 0);
+
+    pipeline->start(50);
+    EXPECT_EQ(pipeline->stats().num_frames, 50);
+}
+
+TEST(Pipeline, initialize) {
+    using hastings::createPipeline;
+    using hastings::ExecutionPolicy;
+    using hastings::MultiImageContextInterface;
+    using hastings::NodeInterface;
+
+    // NOTE(will): each node's initialize waits for the other to start, which only happens if they're initialized concurrently.
+    struct WarmUpNode final : NodeInterface {
+        WarmUpNode(std::atomic<int>& num_started, std::atomic<int>& num_initialized)
+            : num_started_(num_started), num_initialized_(num_initialized) {}
+
+        ExecutionPolicy executionPolicy() const override final { return ExecutionPolicy::Ordered; }
+        std::string name() const override final { return "WarmUpNode"; }
+
+        void initialize() override final {
+            num_started_ += 1;
+
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (num_started_ < 2 && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+            num_initialized_ += 1;
+        }
+
+        void process(MultiImageContextInterface& multi_context) override final { EXPECT_EQ(num_initialized_, 2); }
+
+        std::atomic<int>& num_started_;
+        std::atomic<int>& num_initialized_;
+    };
+
+    std::atomic<int> num_started = 0;
+    std::atomic<int> num_initialized = 0;
+
+    const auto pipeline = createPipeline(2);
+    pipeline->add<WarmUpNode>(num_started, num_initialized);
+    pipeline->add<WarmUpNode>(num_started, num_initialized);
+    pipeline->initialize();
+
+    EXPECT_EQ(num_started, 2);
+    EXPECT_EQ(num_initialized, 2);
+
+    pipeline->start(10);
+    pipeline->start(10);
+    EXPECT_EQ(num_initialized, 2);
+}
+
+TEST(Pipeline, process) {
+    using hastings::createMultiImageContext;
+    using hastings::createPipeline;
+    using hastings::Dependencies;
+    using hastings::MultiImageContextInterface;
+
+    const auto pipeline = createPipeline(2);
+    pipeline->add<DeclaredNode>(Dependencies{{}, {"Y"}}, [](MultiImageContextInterface& multi_context) { multi_context.result("Y") = 1; });
+    pipeline->add<DeclaredNode>(Dependencies{{"Y"}, {"diff"}}, [](MultiImageContextInterface& multi_context) {
+        multi_context.result("diff") = std::any_cast<int>(multi_context.result("Y")) + 1;
+    });
+
+    const auto multi_context = createMultiImageContext();
+    pipeline->process(*multi_context);
+
+    EXPECT_EQ(std::any_cast<int>(multi_context->result("diff")), 2);
+    EXPECT_EQ(pipeline->stats().num_frames, 1);
+}
+
+TEST(Pipeline, submitFromThreads) {
+    using hastings::createMultiImageContext;
+    using hastings::createPipeline;
+    using hastings::MultiImageContextInterface;
+
+    const auto num_threads = 4;
+    const auto num_requests = 50;
+
+    const auto pipeline = createPipeline(4);
+    pipeline->add<hastings::OrderedNode>();
+    pipeline->add<hastings::ParallelNode>();
+
+    std::vector<std::thread> threads;
+    for (auto idx = 0; idx < num_threads; ++idx) {
+        threads.emplace_back([&pipeline] {
+            std::vector<MultiImageContextInterface::Ptr> multi_contexts;
+            std::vector<std::future<void>> requests;
+            for (auto request = 0; request < num_requests; ++request) {
+                auto& multi_context = *multi_contexts.emplace_back(createMultiImageContext());
+                requests.emplace_back(pipeline->submit(multi_context));
+            }
+
+            for (auto& request : requests) {
+                request.get();
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(pipeline->stats().num_frames, num_threads * num_requests);
+
+    // NOTE(will): ordered nodes see submitted frames in order of their ids, a start carries on after them.
+    pipeline->start(10);
+    EXPECT_EQ(pipeline->stats().num_frames, num_threads * num_requests + 10);
+}
+
+TEST(Pipeline, submitWhileStopping) {
+    using hastings::createMultiImageContext;
+    using hastings::createPipeline;
+
+    const auto pipeline = createPipeline(2);
+    pipeline->add<hastings::OrderedNode>();
+    pipeline->stop();
+
+    // NOTE(will): a pending stop is for the next start, a submitted frame still takes the next id and runs.
+    const auto multi_context = createMultiImageContext();
+    pipeline->submit(*multi_context).get();
+    EXPECT_EQ(multi_context->frameId(), 0);
+
+    pipeline->start(10);
+    EXPECT_EQ(pipeline->stats().num_frames, 1);
+
+    pipeline->start(10);
+    EXPECT_EQ(pipeline->stats().num_frames, 11);
+}
+
+TEST(PipelineBenchmark, ProcessOverhead) {
+    using hastings::createMultiImageContext;
+    using hastings::createPipeline;
+    using hastings::MultiImageContextInterface;
+
+    const auto num_requests = 20000;
+
+    const auto pipeline = createPipeline(4);
+    pipeline->add<DeclaredNode>(hastings::Dependencies{{}, {"Y"}}, [](MultiImageContextInterface&) {});
+    pipeline->initialize();
+
+    const auto multi_context = createMultiImageContext();
+    const auto start = std::chrono::steady_clock::now();
+    for (auto request = 0; request < num_requests; ++request) {
+        pipeline->process(*multi_context);
+    }
+    const auto duration = std::chrono::steady_clock::now() - start;
+
+    const auto overhead = std::chrono::duration<double, std::micro>(duration).count() / num_requests;
+    std::cout << "[ process ] overhead: " << overhead << "us" << std::endl;
+    RecordProperty("process_us", std::to_string(overhead));
+}
+
+TEST(Pipeline, addCamera) {
+    using hastings::createPipeline;
+    using hastings::MultiImageContextInterface;
+
+    std::atomic<int> num_frames = 0;
+    std::atomic<int> num_missing = 0;
+
+    const auto pipeline = createPipeline(4);
+    const auto left = pipeline->addCamera("left");
+    const auto right = pipeline->addCamera("right");
+
+    // NOTE(will): nothing makes the cameras during the frame, they're all there from the first one.
+    pipeline->add<DeclaredNode>(hastings::Dependencies{{}, {}}, [&](MultiImageContextInterface& multi_context) {
+        const auto& cameras = multi_context.cameras();
+        num_missing += cameras.size() != 2 || std::get<2>(cameras[0]) != left || std::get<2>(cameras[1]) != right;
+        num_frames += 1;
+    });
+    pipeline->add<hastings::CameraStateNode>();
+    pipeline->start(50);
+
+    EXPECT_EQ(num_frames, 50);
+    EXPECT_EQ(num_missing, 0);
+}
+
+TEST(Pipeline, memoryBudget) {
+    using hastings::createPipeline;
+    using hastings::MultiImageContextInterface;
+
+    std::atomic<int> num_running = 0;
+    std::atomic<int> max_running = 0;
+
+    const auto pipeline = createPipeline(4);
+    pipeline->add<DeclaredNode>(hastings::Dependencies{{}, {"BGR"}}, [&](MultiImageContextInterface& multi_context) {
+        const auto running = ++num_running;
+        max_running = std::max(max_running.load(), running);
+
+        multi_context.image("BGR").create(480, 640, CV_8UC3);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        num_running -= 1;
+    });
+
+    // NOTE(will): nothing is measured before the first frames finish, so those all run.
+    pipeline->start(8);
+    EXPECT_GE(pipeline->stats().bytes_in_use, 480 * 640 * 3);
+
+    pipeline->memoryBudget(1);
+    max_running = 0;
+    pipeline->start(50);
+
+    const auto stats = pipeline->stats();
+    EXPECT_EQ(stats.num_frames, 58);
+    EXPECT_GT(stats.num_throttled, 0);
+    EXPECT_EQ(max_running, 1);
+    EXPECT_LE(stats.bytes_in_use, 2 * 480 * 640 * 3);
+}
+
+TEST(Pipeline, memoryBudgetPreviousFrameInputs) {
+    using hastings::createPipeline;
+    using hastings::Dependencies;
+    using hastings::MultiImageContextInterface;
+
+    std::atomic<int> num_mismatched = 0;
+
+    const auto pipeline = createPipeline(4);
+    pipeline->memoryBudget(1);
+    pipeline->add<DeclaredNode>(Dependencies{{}, {"BGR"}, {"BGR"}}, [&](MultiImageContextInterface& multi_context) {
+        const auto previous = multi_context.previous();
+        if (previous != nullptr) {
+            num_mismatched += previous->view(hastings::Key("BGR")).at<float>(0, 0) + 1 != multi_context.frameId();
+        }
+
+        auto& image = multi_context.image("BGR");
+        image.create(120, 160, CV_32FC1);
+        image.at<float>(0, 0) = multi_context.frameId();
+    });
+    pipeline->start(200);
+
+    EXPECT_EQ(num_mismatched, 0);
+    EXPECT_EQ(pipeline->stats().num_frames, 200);
+}
+
+TEST(Pipeline, memoryStats) {
+    using hastings::createPipeline;
+    using hastings::MultiImageContextInterface;
+
+    const auto pipeline = createPipeline(2);
+    pipeline->addCamera("camera");
+    pipeline->add<DeclaredNode>(hastings::Dependencies{{}, {"BGR"}}, [](MultiImageContextInterface& multi_context) {
+        multi_context.cameras("camera")->image("BGR").create(48, 64, CV_8UC3);
+    });
+    pipeline->start(10);
+
+    const auto stats = pipeline->stats();
+    ASSERT_EQ(stats.memory.size(), 1);
+    EXPECT_EQ(stats.memory[0].camera, "camera");
+    EXPECT_EQ(stats.memory[0].key, "BGR");
+    EXPECT_EQ(stats.memory[0].bytes, 48 * 64 * 3);
+    EXPECT_TRUE(stats.memory[0].is_new);
+}
+
+TEST(Pipeline, derive) {
+    using hastings::createPipeline;
+    using hastings::ImageContextInterface;
+    using hastings::Key;
+    using hastings::MultiImageContextInterface;
+
+    std::atomic<int> num_derived = 0;
+    std::atomic<int> num_missing = 0;
+
+    const auto pipeline = createPipeline(4);
+    pipeline->derive("Y", {"BGR"}, [&num_derived, bgr = Key("BGR")](ImageContextInterface& context, cv::Mat& image) {
+        num_derived += 1;
+        context.view(bgr).copyTo(image);
+    });
+    pipeline->derive("unused", {"BGR"}, [&num_derived](ImageContextInterface& context, cv::Mat& image) { num_derived += 100; });
+
+    pipeline->add<DeclaredNode>(hastings::Dependencies{{}, {"BGR"}}, [](MultiImageContextInterface& multi_context) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        multi_context.image("BGR") = cv::Mat::zeros(4, 4, CV_8UC1);
+    });
+
+    // NOTE(will): the reader doesn't declare BGR, reading Y is enough for it to wait on BGR's writer
+    pipeline->add<DeclaredNode>(hastings::Dependencies{{"Y"}, {"diff"}}, [&num_missing](MultiImageContextInterface& multi_context) {
+        num_missing += multi_context.view(Key("Y")).empty();
+    });
+    pipeline->start(50);
+
+    EXPECT_EQ(num_derived, 50);
+    EXPECT_EQ(num_missing, 0);
+}
+
+TEST(Pipeline, deriveAfterAdd) {
+    using hastings::createPipeline;
+    using hastings::ImageContextInterface;
+
+    const auto pipeline = createPipeline(2);
+    pipeline->add<hastings::OrderedNode>();
+    EXPECT_THROW(pipeline->derive("Y", {"BGR"}, [](ImageContextInterface& context, cv::Mat& image) {}), std::logic_error);
+}
+
+TEST(Pipeline, submitPreparesOnce) {
+    using hastings::createMultiImageContext;
+    using hastings::createPipeline;
+    using hastings::ImageContextInterface;
+    using hastings::Key;
+    using hastings::MultiImageContextInterface;
+
+    std::atomic<int> rows = 0;
+
+    const auto pipeline = createPipeline(2);
+    pipeline->derive("Y", {}, [](ImageContextInterface& context, cv::Mat& image) { image = cv::Mat::zeros(1, 1, CV_8UC1); });
+    pipeline->add<DeclaredNode>(hastings::Dependencies{{"Y"}, {"rows"}}, [&rows](MultiImageContextInterface& multi_context) {
+        rows += multi_context.view(Key("Y")).rows;
+    });
+
+    const auto multi_context = createMultiImageContext();
+    pipeline->submit(*multi_context).get();
+
+    // NOTE(will): the first submit prepares the context, a derivation it registers itself afterwards isn't replaced by the next.
+    multi_context->clear();
+    multi_context->derive(Key("Y"), [](ImageContextInterface& context, cv::Mat& image) { image = cv::Mat::zeros(2, 1, CV_8UC1); });
+    pipeline->submit(*multi_context).get();
+
+    EXPECT_EQ(rows, 3);
+}
+
+TEST(Pipeline, retain) {
+    using hastings::createPipeline;
+    using hastings::ExecutionPolicy;
+    using hastings::Key;
+    using hastings::MultiImageContextInterface;
+
+    std::atomic<int> num_checked = 0;
+    std::atomic<int> num_wrong = 0;
+
+    const auto pipeline = createPipeline(4);
+    pipeline->retain("BGR", 1);
+    pipeline->add<DeclaredNode>(hastings::Dependencies{{}, {"BGR"}}, [](MultiImageContextInterface& multi_context) {
+        multi_context.image("BGR") = cv::Mat::zeros(1, 1, CV_32FC1);
+        multi_context.image("BGR").at<float>(0, 0) = float(multi_context.frameId());
+    });
+
+    // NOTE(will): the ordered reader of frame N runs after the one of frame N - 1, so BGR's writer for N - 1 has been recorded.
+    pipeline->add<DeclaredNode>(
+        hastings::Dependencies{{"BGR"}, {"diff"}},
+        [&](MultiImageContextInterface& multi_context) {
+            const auto previous = multi_context.history(Key("BGR"), 1);
+            if (multi_context.frameId() == 0) {
+                num_wrong += !previous.empty();
+                return;
+            }
+
+            num_checked += 1;
+            num_wrong += previous.empty() || previous.at<float>(0, 0) != float(multi_context.frameId() - 1);
+        },
+        ExecutionPolicy::Ordered);
+    pipeline->start(50);
+
+    EXPECT_EQ(num_checked, 49);
+    EXPECT_EQ(num_wrong, 0);
+}
+
+TEST(Pipeline, retainLastWriter) {
+    using hastings::createPipeline;
+    using hastings::ExecutionPolicy;
+    using hastings::Key;
+    using hastings::MultiImageContextInterface;
+
+    std::atomic<int> num_wrong = 0;
+
+    const auto pipeline = createPipeline(4);
+    pipeline->retain("BGR", 1);
+    pipeline->add<DeclaredNode>(hastings::Dependencies{{}, {"BGR"}}, [](MultiImageContextInterface& multi_context) {
+        multi_context.image("BGR") = cv::Mat::zeros(1, 1, CV_32FC1);
+    });
+
+    // NOTE(will): BGR is recorded once its second writer is done with it, the first one's version isn't kept
+    pipeline->add<DeclaredNode>(hastings::Dependencies{{"BGR"}, {"BGR"}}, [](MultiImageContextInterface& multi_context) {
+        multi_context.image("BGR").at<float>(0, 0) = float(multi_context.frameId());
+    });
+    pipeline->add<DeclaredNode>(
+        hastings::Dependencies{{"BGR"}, {"diff"}},
+        [&](MultiImageContextInterface& multi_context) {
+            const auto previous = multi_context.history(Key("BGR"), 1);
+            if (multi_context.frameId() != 0) {
+                num_wrong += previous.empty() || previous.at<float>(0, 0) != float(multi_context.frameId() - 1);
+            }
+        },
+        ExecutionPolicy::Ordered);
+    pipeline->start(50);
+
+    EXPECT_EQ(num_wrong, 0);
+}
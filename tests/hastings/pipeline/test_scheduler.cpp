@@ -0,0 +1,84 @@
+#include <gmock/gmock-matchers.h>
+#include <gtest/gtest.h>
+#include <hastings/pipeline/scheduler.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+
+TEST(Scheduler, Construction) {
+    using hastings::Scheduler;
+
+    Scheduler scheduler(4);
+    EXPECT_EQ(scheduler.numThreads(), 4);
+}
+
+TEST(Scheduler, ConstructionNoThreads) {
+    using hastings::Scheduler;
+
+    EXPECT_THROW(Scheduler(0), std::invalid_argument);
+}
+
+TEST(Scheduler, DrainsOnDestruction) {
+    using hastings::Scheduler;
+
+    std::atomic<int> count = 0;
+    {
+        Scheduler scheduler(4);
+        for (auto idx = 0; idx < 1000; ++idx) {
+            scheduler.submit([&count] { count += 1; });
+        }
+    }
+
+    EXPECT_EQ(count, 1000);
+}
+
+TEST(Scheduler, NestedSubmit) {
+    using hastings::Scheduler;
+
+    std::atomic<int> count = 0;
+    {
+        Scheduler scheduler(4);
+        for (auto idx = 0; idx < 100; ++idx) {
+            scheduler.submit([&scheduler, &count] {
+                for (auto jdx = 0; jdx < 10; ++jdx) {
+                    scheduler.submit([&count] { count += 1; });
+                }
+            });
+        }
+    }
+
+    EXPECT_EQ(count, 1000);
+}
+
+TEST(Scheduler, StealsFromBusyWorker) {
+    using hastings::Scheduler;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::set<std::thread::id> thread_ids;
+    bool release = false;
+
+    {
+        Scheduler scheduler(2);
+        scheduler.submit([&] {
+            // NOTE(will): queued on this worker's deque, so only a steal lets them run while it's blocked.
+            for (auto idx = 0; idx < 4; ++idx) {
+                scheduler.submit([&] {
+                    std::lock_guard lock(mutex);
+                    thread_ids.emplace(std::this_thread::get_id());
+                    release = true;
+                    cv.notify_all();
+                });
+            }
+
+            std::unique_lock lock(mutex);
+            cv.wait(lock, [&] { return release; });
+            thread_ids.emplace(std::this_thread::get_id());
+        });
+    }
+
+    EXPECT_EQ(thread_ids.size(), 2);
+}
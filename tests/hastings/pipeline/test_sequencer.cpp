@@ -0,0 +1,185 @@
+#include <gmock/gmock-matchers.h>
+#include <gtest/gtest.h>
+#include <hastings/pipeline/sequencer.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+TEST(Sequencer, Construction) {
+    using hastings::Sequencer;
+
+    Sequencer sequencer;
+    EXPECT_EQ(sequencer.current(), 0);
+}
+
+TEST(Sequencer, ConstructionNoSlots) {
+    using hastings::Sequencer;
+
+    EXPECT_THROW(Sequencer(0), std::invalid_argument);
+}
+
+TEST(Sequencer, Advance) {
+    using hastings::Sequencer;
+
+    Sequencer sequencer;
+    sequencer.wait(0);
+
+    EXPECT_FALSE(sequencer.advance());
+    EXPECT_EQ(sequencer.current(), 1);
+}
+
+TEST(Sequencer, ParkCurrent) {
+    using hastings::Sequencer;
+
+    Sequencer sequencer;
+
+    auto num_calls = 0;
+    EXPECT_TRUE(sequencer.park(0, [&num_calls] { num_calls += 1; }));
+    EXPECT_EQ(num_calls, 0);
+}
+
+TEST(Sequencer, ParkFuture) {
+    using hastings::Sequencer;
+
+    Sequencer sequencer(2);
+
+    std::vector<int> calls;
+    EXPECT_FALSE(sequencer.park(1, [&calls] { calls.emplace_back(1); }));
+    EXPECT_FALSE(sequencer.park(3, [&calls] { calls.emplace_back(3); }));
+
+    const auto task_1 = sequencer.advance();
+    ASSERT_TRUE(task_1);
+    task_1();
+
+    EXPECT_FALSE(sequencer.advance());
+
+    const auto task_3 = sequencer.advance();
+    ASSERT_TRUE(task_3);
+    task_3();
+
+    EXPECT_THAT(calls, testing::ElementsAre(1, 3));
+}
+
+TEST(Sequencer, SkipCurrent) {
+    using hastings::Sequencer;
+
+    Sequencer sequencer;
+
+    EXPECT_FALSE(sequencer.skip(0));
+    EXPECT_EQ(sequencer.current(), 1);
+}
+
+TEST(Sequencer, SkipFuture) {
+    using hastings::Sequencer;
+
+    Sequencer sequencer(2);
+
+    std::vector<int> calls;
+    EXPECT_FALSE(sequencer.skip(1));
+    EXPECT_FALSE(sequencer.skip(2));
+    EXPECT_FALSE(sequencer.park(3, [&calls] { calls.emplace_back(3); }));
+    EXPECT_EQ(sequencer.current(), 0);
+
+    const auto task_3 = sequencer.advance();
+    ASSERT_TRUE(task_3);
+    task_3();
+
+    EXPECT_EQ(sequencer.current(), 3);
+    EXPECT_THAT(calls, testing::ElementsAre(3));
+}
+
+TEST(Sequencer, WaitOrdering) {
+    using hastings::Sequencer;
+
+    Sequencer sequencer(4);
+
+    const auto num_threads = 32;
+    std::vector<int> ordering;
+    std::vector<std::thread> threads;
+
+    for (auto idx = num_threads - 1; idx >= 0; --idx) {
+        threads.emplace_back([&sequencer, &ordering, idx] {
+            sequencer.wait(idx);
+            ordering.emplace_back(idx);
+            sequencer.advance();
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<int> expected_ordering(num_threads);
+    std::iota(expected_ordering.begin(), expected_ordering.end(), 0);
+    EXPECT_THAT(ordering, testing::ElementsAreArray(expected_ordering));
+}
+
+// NOTE(will): the OrderedExecutor handoff this sequencer replaced, kept as a baseline for the benchmark.
+class NotifyAllSequencer {
+  public:
+    void wait(const std::size_t ticket) {
+        std::unique_lock lock(mutex_);
+        cv_.wait(lock, [&] { return ticket == current_; });
+    }
+
+    void advance() {
+        {
+            std::lock_guard lock(mutex_);
+            current_ += 1;
+        }
+        cv_.notify_all();
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::size_t current_ = 0;
+};
+
+template <class SequencerT>
+double handoffLatency(const int num_threads, const int num_handoffs) {
+    SequencerT sequencer;
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (auto idx = 0; idx < num_threads; ++idx) {
+        threads.emplace_back([&sequencer, num_threads, num_handoffs, idx] {
+            for (auto ticket = std::size_t(idx); ticket < num_handoffs; ticket += num_threads) {
+                sequencer.wait(ticket);
+                sequencer.advance();
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const auto duration = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::micro>(duration).count() / num_handoffs;
+}
+
+class SequencerBenchmark : public testing::TestWithParam<int> {};
+
+TEST_P(SequencerBenchmark, HandoffLatency) {
+    using hastings::Sequencer;
+
+    const auto num_threads = GetParam();
+    const auto num_handoffs = 2000;
+
+    const auto latency = handoffLatency<Sequencer>(num_threads, num_handoffs);
+    const auto baseline = handoffLatency<NotifyAllSequencer>(num_threads, num_handoffs);
+
+    std::cout << "[ handoff ] threads: " << num_threads << " sequencer: " << latency << "us notify_all: " << baseline << "us"
+              << std::endl;
+    RecordProperty("sequencer_us", std::to_string(latency));
+    RecordProperty("notify_all_us", std::to_string(baseline));
+}
+
+INSTANTIATE_TEST_SUITE_P(Threads, SequencerBenchmark, testing::Values(4, 16, 64));
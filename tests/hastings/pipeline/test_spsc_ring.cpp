@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <hastings/pipeline/spsc_ring.h>
+
+#include <thread>
+#include <vector>
+
+TEST(SpscRing, Capacity) {
+    using hastings::SpscRing;
+
+    EXPECT_EQ(SpscRing<int>(1).capacity(), 1);
+    EXPECT_EQ(SpscRing<int>(5).capacity(), 8);
+    EXPECT_EQ(SpscRing<int>(16).capacity(), 16);
+    EXPECT_THROW(SpscRing<int>(0), std::invalid_argument);
+}
+
+TEST(SpscRing, PushPop) {
+    using hastings::SpscRing;
+
+    SpscRing<int> ring(4);
+
+    int value = 0;
+    EXPECT_FALSE(ring.pop(value));
+
+    EXPECT_TRUE(ring.push(1));
+    EXPECT_TRUE(ring.push(2));
+
+    EXPECT_TRUE(ring.pop(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_TRUE(ring.pop(value));
+    EXPECT_EQ(value, 2);
+    EXPECT_FALSE(ring.pop(value));
+}
+
+TEST(SpscRing, Full) {
+    using hastings::SpscRing;
+
+    SpscRing<int> ring(2);
+    EXPECT_TRUE(ring.push(1));
+    EXPECT_TRUE(ring.push(2));
+    EXPECT_FALSE(ring.push(3));
+
+    int value = 0;
+    EXPECT_TRUE(ring.pop(value));
+    EXPECT_TRUE(ring.push(3));
+}
+
+TEST(SpscRing, ProducerConsumer) {
+    using hastings::SpscRing;
+
+    const auto num_values = 100000;
+    SpscRing<int> ring(64);
+
+    std::thread producer([&ring] {
+        for (auto idx = 0; idx < num_values; ++idx) {
+            while (!ring.push(int(idx))) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    std::vector<int> values;
+    values.reserve(num_values);
+    while (values.size() < num_values) {
+        int value = 0;
+        if (ring.pop(value)) {
+            values.emplace_back(value);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    for (auto idx = 0; idx < num_values; ++idx) {
+        ASSERT_EQ(values[idx], idx);
+    }
+}
+
+TEST(ReorderRing, TakeInOrder) {
+    using hastings::ReorderRing;
+
+    ReorderRing<int> ring(4);
+    int values[3] = {0, 1, 2};
+
+    ring.put(2, &values[2]);
+    ring.put(1, &values[1]);
+    EXPECT_EQ(ring.take(0), nullptr);
+
+    ring.put(0, &values[0]);
+    EXPECT_EQ(ring.take(0), &values[0]);
+    EXPECT_EQ(ring.take(1), &values[1]);
+    EXPECT_EQ(ring.take(2), &values[2]);
+    EXPECT_EQ(ring.take(3), nullptr);
+}
+
+TEST(ReorderRing, ManyProducers) {
+    using hastings::ReorderRing;
+
+    const auto num_threads = 4;
+    const auto num_values = 4000;
+
+    ReorderRing<int> ring(num_values);
+    std::vector<int> values(num_values);
+
+    std::vector<std::thread> threads;
+    for (auto idx = 0; idx < num_threads; ++idx) {
+        threads.emplace_back([&, idx] {
+            for (auto sequence = idx; sequence < num_values; sequence += num_threads) {
+                values[sequence] = sequence;
+                ring.put(sequence, &values[sequence]);
+            }
+        });
+    }
+
+    for (auto sequence = 0; sequence < num_values; ++sequence) {
+        int* value = nullptr;
+        while ((value = ring.take(sequence)) == nullptr) {
+            std::this_thread::yield();
+        }
+        ASSERT_EQ(*value, sequence);
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
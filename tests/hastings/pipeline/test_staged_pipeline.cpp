@@ -0,0 +1,260 @@
+#include <gmock/gmock-matchers.h>
+#include <gtest/gtest.h>
+#include <hastings/pipeline/context.h>
+#include <hastings/pipeline/pipeline.h>
+
+#include <atomic>
+#include <functional>
+#include <numeric>
+#include <thread>
+
+#include "helpers.h"
+
+namespace {
+using FnCallback = std::function<void(hastings::MultiImageContextInterface&)>;
+
+struct LambdaNode final : hastings::NodeInterface {
+    LambdaNode(hastings::ExecutionPolicy policy, FnCallback fn) : policy_(policy), fn_(std::move(fn)) {}
+
+    hastings::ExecutionPolicy executionPolicy() const override final { return policy_; }
+    std::string name() const override final { return "LambdaNode"; }
+    void process(hastings::MultiImageContextInterface& multi_context) override final { fn_(multi_context); }
+
+    hastings::ExecutionPolicy policy_;
+    FnCallback fn_;
+};
+}  // namespace
+
+TEST(StagedPipeline, Construction) {
+    using hastings::createStagedPipeline;
+
+    const auto pipeline = createStagedPipeline();
+    EXPECT_NE(pipeline, nullptr);
+}
+
+TEST(StagedPipeline, Empty) {
+    using hastings::createStagedPipeline;
+
+    const auto pipeline = createStagedPipeline(2);
+    pipeline->start(100);
+
+    EXPECT_EQ(pipeline->stats().num_frames, 100);
+}
+
+TEST(StagedPipeline, LatencyBudgetUnsupported) {
+    using hastings::createStagedPipeline;
+
+    const auto pipeline = createStagedPipeline(2);
+    EXPECT_THROW(pipeline->latencyBudget(std::chrono::milliseconds(10)), std::logic_error);
+}
+
+TEST(StagedPipeline, OrderedStages) {
+    using hastings::createStagedPipeline;
+    using hastings::ExecutionPolicy;
+    using hastings::MultiImageContextInterface;
+
+    std::vector<std::size_t> frame_ids;
+    std::atomic<int> num_parallel = 0;
+
+    const auto pipeline = createStagedPipeline(4);
+    pipeline->add<LambdaNode>(ExecutionPolicy::Parallel, [&num_parallel](MultiImageContextInterface& multi_context) {
+        multi_context.result("a") = int(multi_context.frameId());
+        num_parallel += 1;
+    });
+    pipeline->add<hastings::OrderedNode>();
+    pipeline->add<LambdaNode>(ExecutionPolicy::Parallel, [](MultiImageContextInterface& multi_context) {
+        ASSERT_EQ(multi_context.result<int>("a"), multi_context.frameId());
+    });
+    pipeline->add<LambdaNode>(ExecutionPolicy::Parallel, [&num_parallel](MultiImageContextInterface&) { num_parallel += 1; });
+    pipeline->add<hastings::UnorderedNode>();
+    pipeline->add<LambdaNode>(ExecutionPolicy::Ordered,
+                              [&frame_ids](MultiImageContextInterface& multi_context) { frame_ids.emplace_back(multi_context.frameId()); });
+    pipeline->start(500);
+
+    std::vector<std::size_t> expected_ids(500);
+    std::iota(expected_ids.begin(), expected_ids.end(), 0);
+
+    EXPECT_THAT(frame_ids, testing::ElementsAreArray(expected_ids));
+    EXPECT_EQ(num_parallel, 1000);
+
+    const auto stats = pipeline->stats();
+    EXPECT_EQ(stats.num_frames, 500);
+    ASSERT_EQ(stats.nodes.size(), 6);
+    for (const auto& node : stats.nodes) {
+        EXPECT_EQ(node.run.count, 500);
+    }
+}
+
+TEST(StagedPipeline, ParallelLast) {
+    using hastings::createStagedPipeline;
+    using hastings::ExecutionPolicy;
+    using hastings::MultiImageContextInterface;
+
+    std::atomic<int> num_frames = 0;
+
+    const auto pipeline = createStagedPipeline(4);
+    pipeline->add<hastings::OrderedNode>();
+    pipeline->add<LambdaNode>(ExecutionPolicy::Parallel, [&num_frames](MultiImageContextInterface&) { num_frames += 1; });
+    pipeline->start(200);
+
+    EXPECT_EQ(num_frames, 200);
+    EXPECT_EQ(pipeline->stats().num_frames, 200);
+}
+
+TEST(StagedPipeline, BatchedUnsupported) {
+    using hastings::BatchNode;
+    using hastings::createStagedPipeline;
+
+    const auto pipeline = createStagedPipeline(2);
+    EXPECT_THROW(pipeline->add<BatchNode>(4, std::chrono::milliseconds(1)), std::invalid_argument);
+}
+
+TEST(StagedPipeline, Replicated) {
+    using hastings::createStagedPipeline;
+    using hastings::UnorderedNode;
+
+    const auto pipeline = createStagedPipeline(4);
+    pipeline->addReplicated<UnorderedNode>(4);
+    pipeline->start(100);
+
+    EXPECT_EQ(pipeline->stats().num_frames, 100);
+}
+
+TEST(StagedPipeline, PreviousFrameInputsUnsupported) {
+    using hastings::createStagedPipeline;
+    using hastings::Dependencies;
+    using hastings::ExecutionPolicy;
+    using hastings::MultiImageContextInterface;
+
+    struct PreviousNode final : hastings::NodeInterface {
+        ExecutionPolicy executionPolicy() const override final { return ExecutionPolicy::Parallel; }
+        std::string name() const override final { return "PreviousNode"; }
+        std::optional<Dependencies> dependencies() const override final { return Dependencies{{}, {"id"}, {"id"}}; }
+        void process(MultiImageContextInterface& multi_context) override final {}
+    };
+
+    const auto pipeline = createStagedPipeline(2);
+    EXPECT_THROW(pipeline->add<PreviousNode>(), std::invalid_argument);
+}
+
+TEST(StagedPipeline, DeriveAfterAdd) {
+    using hastings::createStagedPipeline;
+    using hastings::ImageContextInterface;
+    using hastings::OrderedNode;
+
+    const auto pipeline = createStagedPipeline(2);
+    pipeline->add<OrderedNode>();
+    EXPECT_THROW(pipeline->derive("Y", {"BGR"}, [](ImageContextInterface& context, cv::Mat& image) {}), std::logic_error);
+}
+
+TEST(StagedPipeline, Restart) {
+    using hastings::createStagedPipeline;
+    using hastings::OrderedNode;
+    using hastings::ParallelNode;
+
+    const auto pipeline = createStagedPipeline(2);
+    pipeline->add<ParallelNode>();
+    pipeline->add<OrderedNode>();
+    pipeline->start(50);
+    pipeline->start(50);
+
+    EXPECT_EQ(pipeline->stats().num_frames, 100);
+}
+
+TEST(StagedPipeline, StopBeforeStart) {
+    using hastings::createStagedPipeline;
+    using hastings::OrderedNode;
+
+    const auto pipeline = createStagedPipeline(2);
+    pipeline->add<OrderedNode>();
+    pipeline->stop();
+    pipeline->start(50);
+    EXPECT_EQ(pipeline->stats().num_frames, 0);
+
+    pipeline->start(50);
+    EXPECT_EQ(pipeline->stats().num_frames, 50);
+}
+
+TEST(StagedPipeline, Process) {
+    using hastings::createMultiImageContext;
+    using hastings::createStagedPipeline;
+    using hastings::OrderedNode;
+    using hastings::ParallelNode;
+
+    const auto pipeline = createStagedPipeline(2);
+    pipeline->add<OrderedNode>();
+    pipeline->add<ParallelNode>();
+
+    const auto multi_context = createMultiImageContext();
+    pipeline->process(*multi_context);
+    pipeline->process(*multi_context);
+    pipeline->start(10);
+
+    EXPECT_EQ(pipeline->stats().num_frames, 12);
+    EXPECT_EQ(multi_context->frameId(), 1);
+}
+
+TEST(StagedPipeline, MemoryBudget) {
+    using hastings::createStagedPipeline;
+    using hastings::ExecutionPolicy;
+    using hastings::MultiImageContextInterface;
+
+    std::atomic<int> num_running = 0;
+    std::atomic<int> max_running = 0;
+
+    const auto pipeline = createStagedPipeline(4);
+    pipeline->add<LambdaNode>(ExecutionPolicy::Parallel, [&](MultiImageContextInterface& multi_context) {
+        const auto running = ++num_running;
+        max_running = std::max(max_running.load(), running);
+
+        multi_context.image("BGR").create(480, 640, CV_8UC3);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        num_running -= 1;
+    });
+
+    // NOTE(will): nothing is measured before the first frames complete, so those all run.
+    pipeline->start(8);
+    EXPECT_GE(pipeline->stats().bytes_in_use, 480 * 640 * 3);
+
+    pipeline->memoryBudget(1);
+    max_running = 0;
+    pipeline->start(50);
+
+    const auto stats = pipeline->stats();
+    EXPECT_EQ(stats.num_frames, 58);
+    EXPECT_GT(stats.num_throttled, 0);
+    EXPECT_EQ(max_running, 1);
+}
+
+TEST(StagedPipeline, Retain) {
+    using hastings::createStagedPipeline;
+    using hastings::ExecutionPolicy;
+    using hastings::Key;
+    using hastings::MultiImageContextInterface;
+
+    std::atomic<int> num_checked = 0;
+    std::atomic<int> num_wrong = 0;
+
+    const auto pipeline = createStagedPipeline(4);
+    pipeline->retain("BGR", 2);
+    pipeline->add<LambdaNode>(ExecutionPolicy::Ordered, [](MultiImageContextInterface& multi_context) {
+        multi_context.cameras("camera")->image(Key("BGR")) = cv::Mat::zeros(1, 1, CV_32FC1);
+        multi_context.cameras("camera")->image(Key("BGR")).at<float>(0, 0) = float(multi_context.frameId());
+    });
+    pipeline->add<LambdaNode>(ExecutionPolicy::Ordered, [&](MultiImageContextInterface& multi_context) {
+        const auto id = multi_context.frameId();
+        if (id < 2) {
+            return;
+        }
+
+        num_checked += 1;
+        const auto camera = multi_context.cameras("camera");
+        const auto previous = camera->history(Key("BGR"), 2);
+        num_wrong += previous.empty() || previous.at<float>(0, 0) != float(id - 2);
+        num_wrong += !multi_context.history(Key("BGR"), 1).empty();
+    });
+    pipeline->start(50);
+
+    EXPECT_EQ(num_checked, 48);
+    EXPECT_EQ(num_wrong, 0);
+}
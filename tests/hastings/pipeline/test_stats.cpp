@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <hastings/pipeline/stats.h>
+
+#include <chrono>
+#include <thread>
+
+TEST(LatencyHistogram, Empty) {
+    using hastings::LatencyHistogram;
+
+    LatencyHistogram histogram;
+    const auto summary = histogram.summary();
+
+    EXPECT_EQ(summary.count, 0);
+    EXPECT_EQ(summary.p50.count(), 0);
+    EXPECT_EQ(summary.max.count(), 0);
+}
+
+TEST(LatencyHistogram, SmallValuesExact) {
+    using hastings::LatencyHistogram;
+    using std::chrono::nanoseconds;
+
+    LatencyHistogram histogram;
+    for (auto idx = 1; idx <= 10; ++idx) {
+        histogram.record(nanoseconds(idx));
+    }
+
+    const auto summary = histogram.summary();
+    EXPECT_EQ(summary.count, 10);
+    EXPECT_EQ(summary.p50, nanoseconds(5));
+    EXPECT_EQ(summary.max, nanoseconds(10));
+}
+
+TEST(LatencyHistogram, Percentiles) {
+    using hastings::LatencyHistogram;
+    using std::chrono::microseconds;
+
+    LatencyHistogram histogram;
+    for (auto idx = 1; idx <= 1000; ++idx) {
+        histogram.record(microseconds(idx));
+    }
+
+    const auto summary = histogram.summary();
+    EXPECT_EQ(summary.count, 1000);
+    EXPECT_NEAR(summary.p50.count(), 500'000, 500'000 * 0.04);
+    EXPECT_NEAR(summary.p99.count(), 990'000, 990'000 * 0.04);
+    EXPECT_NEAR(summary.p999.count(), 999'000, 999'000 * 0.04);
+    EXPECT_EQ(summary.max, microseconds(1000));
+}
+
+TEST(LatencyHistogram, NegativeClamped) {
+    using hastings::LatencyHistogram;
+
+    LatencyHistogram histogram;
+    histogram.record(std::chrono::nanoseconds(-10));
+
+    EXPECT_EQ(histogram.summary().count, 1);
+    EXPECT_EQ(histogram.summary().max.count(), 0);
+}
+
+TEST(LatencyTimer, Records) {
+    using hastings::LatencyHistogram;
+    using hastings::LatencyTimer;
+
+    LatencyHistogram histogram;
+    {
+        LatencyTimer timer(histogram);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    const auto summary = histogram.summary();
+    EXPECT_EQ(summary.count, 1);
+    EXPECT_GE(summary.max, std::chrono::milliseconds(2));
+}